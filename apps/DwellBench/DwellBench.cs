@@ -0,0 +1,203 @@
+//
+// Times the dwell accumulator used by the gaze pointer against the List and Dictionary
+// history it replaced, over the same synthetic gaze at 60, 250 and 1000 Hz, and checks that
+// both give the same dwell time for every sample.
+//
+// DwellBench [--seconds 600] [--targets 40] [--seed n]
+//
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using Microsoft.HandsFree.GazePointer;
+
+namespace DwellBench
+{
+    class Target
+    {
+        public readonly int Index;
+
+        public Target(int index)
+        {
+            Index = index;
+        }
+    }
+
+    /// <summary>
+    /// The history GazePointer.GetHitTargetWithMaxTime kept before DwellAccumulator.
+    /// </summary>
+    class ListDwellHistory<T> where T : class
+    {
+        class GazeHistoryItem
+        {
+            public T HitTarget;
+            public long Timestamp;
+            public int Duration;
+        }
+
+        private readonly List<GazeHistoryItem> _gazeHistory = new List<GazeHistoryItem>();
+        private readonly Dictionary<T, int> _hitTargetTimes = new Dictionary<T, int>();
+        private readonly long _maxHistoryTime;
+        private readonly int _maxInterval;
+
+        public ListDwellHistory(long window, int maxInterval)
+        {
+            _maxHistoryTime = window;
+            _maxInterval = maxInterval;
+        }
+
+        public int Add(T hitTarget, long timestamp)
+        {
+            var historyItem = new GazeHistoryItem { HitTarget = hitTarget, Timestamp = timestamp };
+
+            if (_gazeHistory.Count == 0)
+            {
+                _gazeHistory.Add(historyItem);
+                _hitTargetTimes[hitTarget] = 0;
+                return 0;
+            }
+
+            int elapsed = 0, elapsedPrev = 0;
+            elapsed = (int)Math.Min(timestamp - _gazeHistory[_gazeHistory.Count - 1].Timestamp, _maxInterval);
+            historyItem.Duration = elapsed;
+            _gazeHistory.Add(historyItem);
+
+            _hitTargetTimes.TryGetValue(hitTarget, out elapsedPrev);
+            _hitTargetTimes[hitTarget] = elapsedPrev + elapsed;
+
+            while (_gazeHistory[_gazeHistory.Count - 1].Timestamp - _gazeHistory[0].Timestamp > _maxHistoryTime)
+            {
+                var evOldest = _gazeHistory[0];
+                _gazeHistory.RemoveAt(0);
+                _hitTargetTimes[evOldest.HitTarget] -= evOldest.Duration;
+            }
+
+            return _hitTargetTimes[hitTarget];
+        }
+    }
+
+    class Program
+    {
+        // The default click parameters of GazePointer.Attach: the longest is the 750ms repeat
+        // delay, which GazePointer pads by 500ms
+        const long Window = 750 + 500;
+        const int MaxSampleInterval = 100;
+
+        static readonly int[] Rates = { 60, 250, 1000 };
+
+        /// <summary>
+        /// Fixations of 150 to 900ms on random targets, with the odd second of tracking lost.
+        /// </summary>
+        static void Generate(Random random, Target[] targets, int rate, int seconds, out Target[] hits, out long[] timestamps)
+        {
+            int count = rate * seconds;
+            hits = new Target[count];
+            timestamps = new long[count];
+
+            long start = Environment.TickCount;
+            Target target = targets[0];
+            double fixationEnd = 0;
+            for (int i = 0; i < count; i++)
+            {
+                double time = (i * 1000.0) / rate;
+                if (time >= fixationEnd)
+                {
+                    bool lost = random.NextDouble() < 0.01;
+                    target = targets[random.Next(targets.Length)];
+                    fixationEnd = time + (lost ? 1000 : 150 + random.Next(750));
+                    if (lost)
+                    {
+                        i += rate - 1;
+                        continue;
+                    }
+                }
+
+                hits[i] = target;
+                timestamps[i] = start + (long)time;
+            }
+        }
+
+        static double Time(Func<Target, long, int> add, Target[] hits, long[] timestamps, int[] results)
+        {
+            int count = 0;
+            var stopwatch = Stopwatch.StartNew();
+            for (int i = 0; i < hits.Length; i++)
+            {
+                if (hits[i] != null)
+                {
+                    results[i] = add(hits[i], timestamps[i]);
+                    count++;
+                }
+            }
+            return stopwatch.Elapsed.TotalMilliseconds * 1e6 / count;
+        }
+
+        static int Main(string[] args)
+        {
+            int seconds = 600;
+            int targetCount = 40;
+            int seed = 1;
+            for (int i = 0; i + 1 < args.Length; i += 2)
+            {
+                switch (args[i])
+                {
+                    case "--seconds":
+                        seconds = int.Parse(args[i + 1]);
+                        break;
+                    case "--targets":
+                        targetCount = int.Parse(args[i + 1]);
+                        break;
+                    case "--seed":
+                        seed = int.Parse(args[i + 1]);
+                        break;
+                    default:
+                        Console.Error.WriteLine("usage: DwellBench [--seconds 600] [--targets 40] [--seed n]");
+                        return 2;
+                }
+            }
+
+            var targets = new Target[targetCount];
+            for (int i = 0; i < targetCount; i++)
+            {
+                targets[i] = new Target(i);
+            }
+
+            Console.WriteLine($"{seconds}s of gaze over {targetCount} targets, {Window}ms window");
+            Console.WriteLine($"{"Rate",6}{"Samples",10}{"List ns",10}{"Ring ns",10}{"Speedup",9}{"Mismatches",12}");
+
+            int failures = 0;
+            var random = new Random(seed);
+            foreach (int rate in Rates)
+            {
+                Target[] hits;
+                long[] timestamps;
+                Generate(random, targets, rate, seconds, out hits, out timestamps);
+
+                var listResults = new int[hits.Length];
+                var ringResults = new int[hits.Length];
+
+                // an untimed pass of each over all the samples first, so the timed runs are jitted
+                // even where the runtime only optimizes methods after many calls
+                Time(new ListDwellHistory<Target>(Window, MaxSampleInterval).Add, hits, timestamps, listResults);
+                Time(new DwellAccumulator<Target>(Window) { MaxInterval = MaxSampleInterval }.Add, hits, timestamps, ringResults);
+
+                double listNs = Time(new ListDwellHistory<Target>(Window, MaxSampleInterval).Add, hits, timestamps, listResults);
+                double ringNs = Time(new DwellAccumulator<Target>(Window) { MaxInterval = MaxSampleInterval }.Add, hits, timestamps, ringResults);
+
+                int mismatches = 0;
+                for (int i = 0; i < hits.Length; i++)
+                {
+                    if (listResults[i] != ringResults[i])
+                    {
+                        mismatches++;
+                    }
+                }
+                failures += mismatches;
+
+                Console.WriteLine($"{rate,6}{hits.Length,10}{listNs,10:F1}{ringNs,10:F1}{listNs / ringNs,9:F1}{mismatches,12}");
+            }
+
+            return failures == 0 ? 0 : 1;
+        }
+    }
+}
@@ -0,0 +1,297 @@
+//
+// Drives the frame pipeline from the simulated IrisbondAPI, whose IMAGE_CALLBACK delivers a
+// rendered eye image with every sample, and checks that taking the frames never holds up gaze
+// delivery. Each rate is run with the image callback unset, with the pipeline analyzing frames,
+// and with the pipeline also recording them. Reports the simulator's delivery statistics, the
+// time pushFrame() takes on the tracker's thread and what became of the frames, then reads the
+// recording back and checks every frame against what the analysis callback saw.
+//
+// FramePipelineBench [--rates 60,250,1000] [--seconds 3] [--slots 16] [--dir path]
+//
+
+#include "FramePipelineAPI.h"
+#include "FrameLogFormat.h"
+#include "IrisbondSim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace FramePipeline;
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Set while a run is in progress; the callbacks come from the simulator's thread
+    FRAME_PIPELINE_HANDLE _pipeline = nullptr;
+
+    // pushFrame() timings, only touched from the simulator's thread
+    double _pushTotalUs = 0;
+    double _pushMaxUs = 0;
+    unsigned long long _pushes = 0;
+
+    // Checksum of every frame the analysis callback saw, by sequence number
+    std::mutex _checksumMutex;
+    std::unordered_map<long long, uint64_t> _checksums;
+
+    uint64_t checksum(const unsigned char* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ data[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    void imageCallback(char* data, int rows, int cols, int channels, long long timestamp)
+    {
+        auto start = Clock::now();
+        pushFrame(_pipeline, data, rows, cols, channels, timestamp);
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        _pushTotalUs += us;
+        _pushMaxUs = std::max(_pushMaxUs, us);
+        _pushes++;
+    }
+
+    void dataCallback(
+        long long timestamp,
+        float mouseX, float mouseY,
+        float /*mouseRawX*/, float /*mouseRawY*/,
+        int /*screenWidth*/, int /*screenHeight*/,
+        bool leftEyeDetected, bool rightEyeDetected,
+        int /*imageWidth*/, int /*imageHeight*/,
+        float /*leftEyeX*/, float /*leftEyeY*/, float leftEyeSize,
+        float /*rightEyeX*/, float /*rightEyeY*/, float rightEyeSize,
+        float distanceFactor)
+    {
+        if (_pipeline != nullptr)
+        {
+            pushFrameSample(_pipeline, timestamp, mouseX, mouseY, leftEyeDetected, rightEyeDetected, leftEyeSize, rightEyeSize, distanceFactor);
+        }
+    }
+
+    void analysisCallback(const FRAME_INFO* frame, const FRAME_METRICS* /*metrics*/, const unsigned char* data, void* /*context*/)
+    {
+        uint64_t hash = checksum(data, static_cast<size_t>(frame->rows) * frame->cols * frame->channels);
+        std::lock_guard<std::mutex> lock(_checksumMutex);
+        _checksums[frame->sequence] = hash;
+    }
+
+    // Every frame in the log must be whole, in order, tied to its own sample and the same as the analysis saw
+    bool verifyRecording(const std::string& path, unsigned long long expected)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            std::fprintf(stderr, "cannot open %s\n", path.c_str());
+            return false;
+        }
+
+        FrameLogHeader header;
+        bool valid = std::fread(&header, sizeof(header), 1, file) == 1 && validFrameLogHeader(header);
+        unsigned long long frames = 0;
+        unsigned long long mismatches = 0;
+        long long lastSequence = -1;
+        std::vector<unsigned char> pixels;
+
+        FrameLogRecord record;
+        while (valid && std::fread(&record, sizeof(record), 1, file) == 1)
+        {
+            pixels.resize(record.dataSize);
+            if (std::fread(pixels.data(), 1, pixels.size(), file) != pixels.size())
+            {
+                break;
+            }
+            frames++;
+
+            bool matched = (record.flags & FRAME_LOG_MATCHED) != 0 && record.sampleTimestamp == record.timestamp;
+            bool ordered = record.sequence > lastSequence;
+            lastSequence = record.sequence;
+
+            std::lock_guard<std::mutex> lock(_checksumMutex);
+            auto found = _checksums.find(record.sequence);
+            bool same = found != _checksums.end() && found->second == checksum(pixels.data(), pixels.size());
+            if (!matched || !ordered || !same)
+            {
+                mismatches++;
+            }
+        }
+        std::fclose(file);
+
+        if (!valid || frames != expected || mismatches != 0)
+        {
+            std::fprintf(stderr, "%s: %s, %llu frames of %llu expected, %llu mismatches\n",
+                path.c_str(), valid ? "valid header" : "invalid header", frames, expected, mismatches);
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<double> parseRates(const char* text)
+    {
+        std::vector<double> rates;
+        while (*text != '\0')
+        {
+            char* end = nullptr;
+            double rate = std::strtod(text, &end);
+            if (end == text)
+            {
+                break;
+            }
+            rates.push_back(rate);
+            text = *end == ',' ? end + 1 : end;
+        }
+        return rates;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr, "usage: FramePipelineBench [--rates 60,250,1000] [--seconds 3] [--slots 16] [--dir path]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<double> rates = { 60, 250, 1000 };
+    double seconds = 3;
+    int slots = 16;
+    std::string dir = ".";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--rates" && hasValue)
+        {
+            rates = parseRates(argv[++i]);
+        }
+        else if (arg == "--seconds" && hasValue)
+        {
+            seconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--slots" && hasValue)
+        {
+            slots = std::atoi(argv[++i]);
+        }
+        else if (arg == "--dir" && hasValue)
+        {
+            dir = argv[++i];
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (rates.empty() || seconds <= 0 || slots <= 0)
+    {
+        usage();
+        return 2;
+    }
+
+    FRAME_PIPELINE_CONFIG config;
+    getDefaultFramePipelineConfig(&config);
+    config.slots = slots;
+
+    IrisbondAPI::setHighPerformanceMode(true);
+    IrisbondAPI::setDataCallback(dataCallback);
+
+    std::printf("%6s %-8s %9s %7s %6s %8s %8s %8s %8s %8s %9s %8s %9s %8s\n",
+        "rate", "frames", "delivered", "dropped", "late", "cb p99", "push", "push max",
+        "lost", "matched", "timed out", "no pupil", "recorded", "MB/s");
+
+    const char* modes[] = { "off", "analyze", "record" };
+    int status = 0;
+    for (double rate : rates)
+    {
+        for (int mode = 0; mode < 3; mode++)
+        {
+            std::string path = dir + "/FrameLog" + std::to_string(static_cast<int>(rate)) + ".bin";
+            _pushTotalUs = _pushMaxUs = 0;
+            _pushes = 0;
+            _checksums.clear();
+
+            if (mode != 0)
+            {
+                _pipeline = createFramePipeline(&config);
+                if (_pipeline == nullptr)
+                {
+                    std::fprintf(stderr, "cannot create the frame pipeline\n");
+                    return 1;
+                }
+                setFrameAnalysisCallback(_pipeline, analysisCallback, nullptr);
+                if (mode == 2 && !startFrameRecording(_pipeline, path.c_str()))
+                {
+                    std::fprintf(stderr, "cannot create %s\n", path.c_str());
+                    return 1;
+                }
+            }
+            IrisbondAPI::setImageCallback(mode != 0 ? imageCallback : nullptr);
+
+            IrisbondSim::setSimulationRate(rate);
+            if (IrisbondAPI::start() != IrisbondAPI::START_STATUS::START_OK)
+            {
+                std::fprintf(stderr, "simulator failed to start at %g Hz\n", rate);
+                return 1;
+            }
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+            IrisbondAPI::stop();
+
+            IrisbondSim::SIMULATION_STATS sim;
+            IrisbondSim::getSimulationStats(&sim);
+
+            // Stopping waits for the pipeline to finish with every frame, so the counters are final
+            FRAME_PIPELINE_STATS frames = {};
+            if (_pipeline != nullptr)
+            {
+                stopFrameRecording(_pipeline);
+                getFramePipelineStats(_pipeline, &frames);
+                destroyFramePipeline(_pipeline);
+                _pipeline = nullptr;
+            }
+
+            std::printf("%6g %-8s %9llu %7llu %6llu %8.0f %8.2f %8.0f %8llu %8llu %9llu %8llu %9llu %8.1f\n",
+                rate, modes[mode],
+                static_cast<unsigned long long>(sim.delivered),
+                static_cast<unsigned long long>(sim.dropped),
+                static_cast<unsigned long long>(sim.late),
+                sim.callbackP99,
+                _pushes != 0 ? _pushTotalUs / _pushes : 0, _pushMaxUs,
+                frames.dropped, frames.matched, frames.timedOut, frames.withoutPupil, frames.recorded,
+                frames.bytesRecorded / seconds / 1e6);
+
+            // Every delivered sample came with a frame, and every frame the pipeline took must be
+            // accounted for, and when recording, be in the log
+            unsigned long long taken = frames.received - frames.dropped;
+            if (mode != 0 && (frames.received != sim.delivered || frames.matched + frames.unmatched != taken))
+            {
+                std::fprintf(stderr, "%g Hz %s: %llu frames of %llu delivered, %llu taken, %llu matched, %llu unmatched\n",
+                    rate, modes[mode], frames.received, static_cast<unsigned long long>(sim.delivered),
+                    taken, frames.matched, frames.unmatched);
+                status = 1;
+            }
+            if (mode == 2 && (frames.recorded != taken || !verifyRecording(path, taken)))
+            {
+                status = 1;
+            }
+            if (mode == 2)
+            {
+                std::remove(path.c_str());
+            }
+        }
+    }
+
+    std::printf("times in microseconds; lost frames are those the pipeline had no free slot for\n");
+    return status;
+}
@@ -0,0 +1,285 @@
+//
+// Times each native gaze filter over synthetic gaze streams, once as a batch per stream
+// through filterSamples() and once as a filter bank stepping all the streams together,
+// and checks that both give the same filtered samples.
+//
+// GazeFilterBench [--streams 1024] [--samples 4000] [--seed n]
+//
+
+#include "GazeFiltersAPI.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace GazeFilters;
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const double Tolerance = 1e-9;
+
+    struct FilterInfo
+    {
+        FILTER_TYPE type;
+        const char* name;
+    };
+
+    const FilterInfo Filters[] =
+    {
+        { FILTER_TYPE::NULL_FILTER, "Null" },
+        { FILTER_TYPE::GAIN_FILTER, "Gain" },
+        { FILTER_TYPE::STAMPE_FILTER, "Stampe" },
+        { FILTER_TYPE::ONE_EURO_FILTER, "OneEuro" },
+        { FILTER_TYPE::SIMPLE_KALMAN_FILTER, "SimpleKalman" },
+        { FILTER_TYPE::AVERAGING_FILTER, "Averaging" }
+    };
+
+    class Random
+    {
+    public:
+        explicit Random(unsigned long long seed) : _state(seed != 0 ? seed : 1) {}
+
+        double uniform()
+        {
+            _state ^= _state >> 12;
+            _state ^= _state << 25;
+            _state ^= _state >> 27;
+            return static_cast<double>((_state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+        }
+
+        double gaussian()
+        {
+            double u = uniform();
+            double v = uniform();
+            return std::sqrt(-2 * std::log(u + 1e-300)) * std::cos(6.283185307179586 * v);
+        }
+
+    private:
+        unsigned long long _state;
+    };
+
+    /** \brief Samples stored stream after stream: samples[stream * length + n].
+    */
+    struct Streams
+    {
+        int count;
+        int length;
+        std::vector<GAZE_SAMPLE> samples;
+    };
+
+    // Fixations with noise, saccades between them and the occasional lost sample, at 60 Hz
+    Streams generate(int count, int length, unsigned long long seed)
+    {
+        Streams streams;
+        streams.count = count;
+        streams.length = length;
+        streams.samples.resize(static_cast<size_t>(count) * length);
+
+        Random random(seed);
+        for (int s = 0; s < count; s++)
+        {
+            double targetX = random.uniform();
+            double targetY = random.uniform();
+            int fixationLeft = 0;
+            long long timestamp = 1000000 + s;
+
+            for (int n = 0; n < length; n++)
+            {
+                if (fixationLeft-- <= 0)
+                {
+                    targetX = random.uniform();
+                    targetY = random.uniform();
+                    fixationLeft = 10 + static_cast<int>(random.uniform() * 50);
+                }
+
+                GAZE_SAMPLE& sample = streams.samples[static_cast<size_t>(s) * length + n];
+                timestamp += 16 + static_cast<int>(random.uniform() * 2);
+                sample.timestamp = timestamp;
+                sample.fixation = FIXATION::UNKNOWN;
+                if (random.uniform() < 0.01)
+                {
+                    sample.x = std::nan("");
+                    sample.y = std::nan("");
+                }
+                else
+                {
+                    sample.x = targetX + 0.01 * random.gaussian();
+                    sample.y = targetY + 0.01 * random.gaussian();
+                }
+            }
+        }
+        return streams;
+    }
+
+    bool same(double a, double b)
+    {
+        if (std::isnan(a) || std::isnan(b))
+        {
+            return std::isnan(a) && std::isnan(b);
+        }
+        return std::fabs(a - b) <= Tolerance;
+    }
+
+    double nanosecondsPerSample(Clock::time_point start, Clock::time_point end, const Streams& streams)
+    {
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        return ns / (static_cast<double>(streams.count) * streams.length);
+    }
+
+    // One filter per stream, each stream filtered as a single batch
+    double runBatches(const FilterInfo& info, const Streams& input, std::vector<GAZE_SAMPLE>& output)
+    {
+        std::vector<FILTER_HANDLE> filters(input.count);
+        for (FILTER_HANDLE& filter : filters)
+        {
+            filter = createFilter(info.type, nullptr);
+        }
+        output = input.samples;
+
+        auto start = Clock::now();
+        for (int s = 0; s < input.count; s++)
+        {
+            filterSamples(filters[s], output.data() + static_cast<size_t>(s) * input.length, input.length);
+        }
+        auto end = Clock::now();
+
+        for (FILTER_HANDLE filter : filters)
+        {
+            destroyFilter(filter);
+        }
+        return nanosecondsPerSample(start, end, input);
+    }
+
+    // One filter bank over all the streams; the inputs are transposed to one row per sample first
+    double runBank(const FilterInfo& info, const Streams& input, std::vector<GAZE_SAMPLE>& output)
+    {
+        size_t total = static_cast<size_t>(input.count) * input.length;
+        std::vector<long long> timestamps(total);
+        std::vector<double> x(total);
+        std::vector<double> y(total);
+        std::vector<FIXATION> fixation(total);
+        for (int s = 0; s < input.count; s++)
+        {
+            for (int n = 0; n < input.length; n++)
+            {
+                const GAZE_SAMPLE& sample = input.samples[static_cast<size_t>(s) * input.length + n];
+                size_t row = static_cast<size_t>(n) * input.count + s;
+                timestamps[row] = sample.timestamp;
+                x[row] = sample.x;
+                y[row] = sample.y;
+                fixation[row] = sample.fixation;
+            }
+        }
+
+        FILTER_BANK_HANDLE bank = createFilterBank(info.type, nullptr, input.count);
+
+        auto start = Clock::now();
+        for (int n = 0; n < input.length; n++)
+        {
+            size_t row = static_cast<size_t>(n) * input.count;
+            filterBankUpdate(bank, &timestamps[row], &x[row], &y[row], &fixation[row]);
+        }
+        auto end = Clock::now();
+
+        destroyFilterBank(bank);
+
+        output = input.samples;
+        for (int s = 0; s < input.count; s++)
+        {
+            for (int n = 0; n < input.length; n++)
+            {
+                GAZE_SAMPLE& sample = output[static_cast<size_t>(s) * input.length + n];
+                size_t row = static_cast<size_t>(n) * input.count + s;
+                sample.x = x[row];
+                sample.y = y[row];
+                sample.fixation = fixation[row];
+            }
+        }
+        return nanosecondsPerSample(start, end, input);
+    }
+
+    size_t countMismatches(const std::vector<GAZE_SAMPLE>& a, const std::vector<GAZE_SAMPLE>& b)
+    {
+        size_t mismatches = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (!same(a[i].x, b[i].x) || !same(a[i].y, b[i].y) || a[i].fixation != b[i].fixation)
+            {
+                mismatches++;
+            }
+        }
+        return mismatches;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr, "usage: GazeFilterBench [--streams 1024] [--samples 4000] [--seed n]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int streamCount = 1024;
+    int sampleCount = 4000;
+    unsigned long long seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--streams" && hasValue)
+        {
+            streamCount = std::atoi(argv[++i]);
+        }
+        else if (arg == "--samples" && hasValue)
+        {
+            sampleCount = std::atoi(argv[++i]);
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (streamCount <= 0 || sampleCount <= 0)
+    {
+        usage();
+        return 2;
+    }
+
+    Streams streams = generate(streamCount, sampleCount, seed);
+
+    std::printf("%d streams of %d samples\n", streamCount, sampleCount);
+    std::printf("%-14s %12s %12s %10s %12s\n", "filter", "batch ns", "bank ns", "speedup", "mismatches");
+
+    int status = 0;
+    std::vector<GAZE_SAMPLE> batchOutput;
+    std::vector<GAZE_SAMPLE> bankOutput;
+    for (const FilterInfo& info : Filters)
+    {
+        double batchNs = runBatches(info, streams, batchOutput);
+        double bankNs = runBank(info, streams, bankOutput);
+        size_t mismatches = countMismatches(batchOutput, bankOutput);
+
+        std::printf("%-14s %12.2f %12.2f %9.1fx %12zu\n",
+            info.name, batchNs, bankNs, batchNs / bankNs, mismatches);
+
+        if (mismatches != 0)
+        {
+            status = 1;
+        }
+    }
+
+    std::printf("times in nanoseconds per sample\n");
+    return status;
+}
@@ -0,0 +1,700 @@
+//
+// Runs the native gaze filters over a corpus of gaze traces for every point of a parameter
+// grid, in parallel across all cores, and reports for each filter and parameter set:
+//
+//   jitter     RMS distance of the filtered point from its mean within each fixation, once
+//              the filter has had time to settle, in screen fractions
+//   onset      time from a saccade leaving a fixation until the filtered point has moved a
+//              tenth of the way to the next fixation, in milliseconds
+//   lag        time from the same saccade until the filtered point is nine tenths of the way
+//   unsettled  saccades after which the filtered point never got nine tenths of the way
+//   ns/sample  time spent in filterSamples() per sample
+//
+// Fixations and saccades are found in the unfiltered trace: consecutive samples within a
+// radius of their running mean form a fixation, and two long enough fixations a short gap
+// apart make a saccade.
+//
+// The corpus is the gaze logs named on the command line, or synthetic traces if there are none.
+// Each parameter takes a comma separated list of values or a start:stop:step range, and
+// defaults to the filter default.
+//
+// GazeFilterSweep [--filters Gain,OneEuro,...] [--saccade list] [--gain list] [--history list]
+//                 [--beta list] [--cutoff list] [--average list] [--radius 0.05] [--settle 200]
+//                 [--traces 16] [--samples 20000] [--seed n] [--threads n] [--csv] [gaze log ...]
+//
+
+#include "GazeFiltersAPI.h"
+#include "GazeLogReader.h"
+#include "RunningStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace GazeFilters;
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const double OnsetProgress = 0.1;
+    const double SettledProgress = 0.9;
+    const long long MinFixationDuration = 100;
+    const long long MaxSaccadeGap = 150;
+
+    enum Parameter
+    {
+        SACCADE_DISTANCE,
+        GAIN,
+        HISTORY_LENGTH,
+        BETA,
+        CUTOFF,
+        AVERAGE_COUNT,
+        PARAMETER_COUNT
+    };
+
+    struct ParameterInfo
+    {
+        const char* name;
+        bool integer;
+        void (*set)(FILTER_PARAMETERS& parameters, double value);
+        double (*get)(const FILTER_PARAMETERS& parameters);
+    };
+
+    const ParameterInfo Parameters[PARAMETER_COUNT] =
+    {
+        { "saccade", false, [](FILTER_PARAMETERS& p, double v) { p.saccadeDistance = v; }, [](const FILTER_PARAMETERS& p) { return p.saccadeDistance; } },
+        { "gain", false, [](FILTER_PARAMETERS& p, double v) { p.gain = v; }, [](const FILTER_PARAMETERS& p) { return p.gain; } },
+        { "history", true, [](FILTER_PARAMETERS& p, double v) { p.historyLength = static_cast<int>(v); }, [](const FILTER_PARAMETERS& p) { return static_cast<double>(p.historyLength); } },
+        { "beta", false, [](FILTER_PARAMETERS& p, double v) { p.beta = v; }, [](const FILTER_PARAMETERS& p) { return p.beta; } },
+        { "cutoff", false, [](FILTER_PARAMETERS& p, double v) { p.cutoff = v; }, [](const FILTER_PARAMETERS& p) { return p.cutoff; } },
+        { "average", true, [](FILTER_PARAMETERS& p, double v) { p.averageCount = static_cast<int>(v); }, [](const FILTER_PARAMETERS& p) { return static_cast<double>(p.averageCount); } }
+    };
+
+    struct FilterInfo
+    {
+        FILTER_TYPE type;
+        const char* name;
+        std::vector<Parameter> parameters;  ///< The parameters the filter uses, swept in this order.
+    };
+
+    const FilterInfo Filters[] =
+    {
+        { FILTER_TYPE::NULL_FILTER, "Null", {} },
+        { FILTER_TYPE::GAIN_FILTER, "Gain", { SACCADE_DISTANCE, GAIN } },
+        { FILTER_TYPE::STAMPE_FILTER, "Stampe", { SACCADE_DISTANCE, HISTORY_LENGTH } },
+        { FILTER_TYPE::ONE_EURO_FILTER, "OneEuro", { BETA, CUTOFF } },
+        { FILTER_TYPE::SIMPLE_KALMAN_FILTER, "SimpleKalman", {} },
+        { FILTER_TYPE::AVERAGING_FILTER, "Averaging", { AVERAGE_COUNT } }
+    };
+
+    class Random
+    {
+    public:
+        explicit Random(unsigned long long seed) : _state(seed != 0 ? seed : 1) {}
+
+        double uniform()
+        {
+            _state ^= _state >> 12;
+            _state ^= _state << 25;
+            _state ^= _state >> 27;
+            return static_cast<double>((_state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+        }
+
+        double gaussian()
+        {
+            double u = uniform();
+            double v = uniform();
+            return std::sqrt(-2 * std::log(u + 1e-300)) * std::cos(6.283185307179586 * v);
+        }
+
+    private:
+        unsigned long long _state;
+    };
+
+    /** \brief Samples [first, last) of a trace that stay within the radius of their mean.
+    */
+    struct Fixation
+    {
+        size_t first;
+        size_t last;
+        double x;
+        double y;
+    };
+
+    /** \brief A jump from one fixation to the next, starting at the first sample after the first.
+    */
+    struct Saccade
+    {
+        size_t onset;
+        size_t end;
+        double fromX, fromY;
+        double toX, toY;
+    };
+
+    struct Trace
+    {
+        std::string name;
+        std::vector<GAZE_SAMPLE> samples;
+        std::vector<Fixation> fixations;
+        std::vector<Saccade> saccades;
+    };
+
+    struct Configuration
+    {
+        const FilterInfo* filter;
+        FILTER_PARAMETERS parameters;
+    };
+
+    struct Result
+    {
+        double jitterSumSquares = 0;
+        long long jitterCount = 0;
+        RunningStats onset;
+        RunningStats lag;
+        long long saccades = 0;
+        long long unsettled = 0;
+        long long samples = 0;
+        double nanoseconds = 0;
+        bool valid = true;
+
+        void merge(const Result& other)
+        {
+            jitterSumSquares += other.jitterSumSquares;
+            jitterCount += other.jitterCount;
+            onset.merge(other.onset);
+            lag.merge(other.lag);
+            saccades += other.saccades;
+            unsettled += other.unsettled;
+            samples += other.samples;
+            nanoseconds += other.nanoseconds;
+            valid = valid && other.valid;
+        }
+    };
+
+    void findFixations(Trace& trace, double radius)
+    {
+        const std::vector<GAZE_SAMPLE>& samples = trace.samples;
+        RunningStats x, y;
+        size_t first = 0;
+        size_t last = 0;
+
+        auto close = [&]()
+        {
+            if (x.count() != 0 && samples[last - 1].timestamp - samples[first].timestamp >= MinFixationDuration)
+            {
+                trace.fixations.push_back({ first, last, x.mean(), y.mean() });
+            }
+            x = RunningStats();
+            y = RunningStats();
+        };
+
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            if (x.count() != 0 && std::hypot(samples[i].x - x.mean(), samples[i].y - y.mean()) > radius)
+            {
+                close();
+            }
+            if (x.count() == 0)
+            {
+                first = i;
+            }
+            x.add(samples[i].x);
+            y.add(samples[i].y);
+            last = i + 1;
+        }
+        close();
+
+        for (size_t i = 1; i < trace.fixations.size(); i++)
+        {
+            const Fixation& from = trace.fixations[i - 1];
+            const Fixation& to = trace.fixations[i];
+            if (samples[to.first].timestamp - samples[from.last - 1].timestamp <= MaxSaccadeGap &&
+                std::hypot(to.x - from.x, to.y - from.y) >= 2 * radius)
+            {
+                trace.saccades.push_back({ from.last, to.last, from.x, from.y, to.x, to.y });
+            }
+        }
+    }
+
+    bool loadLog(const std::string& path, Trace& trace)
+    {
+        GazeLog::GazeLogReader reader;
+        if (!reader.open(path))
+        {
+            return false;
+        }
+
+        // the sensors never pass on a sample without a gaze point, and one would stay in the
+        // filters' state for good
+        trace.name = path;
+        for (size_t i = 0; i < reader.count(); i++)
+        {
+            const GazeLog::GazeLogRecord& record = reader[i];
+            if (!std::isnan(record.x) && !std::isnan(record.y))
+            {
+                trace.samples.push_back({ record.timestamp, record.x, record.y, FIXATION::UNKNOWN });
+            }
+        }
+        return true;
+    }
+
+    // Fixations with noise, saccades between them and the occasional lost sample, at 60 Hz
+    void generate(Trace& trace, int length, unsigned long long seed)
+    {
+        Random random(seed);
+        trace.name = "synthetic " + std::to_string(seed);
+        trace.samples.resize(length);
+
+        double targetX = random.uniform();
+        double targetY = random.uniform();
+        int fixationLeft = 0;
+        long long timestamp = 1000000;
+        for (GAZE_SAMPLE& sample : trace.samples)
+        {
+            if (fixationLeft-- <= 0)
+            {
+                targetX = random.uniform();
+                targetY = random.uniform();
+                fixationLeft = 10 + static_cast<int>(random.uniform() * 50);
+            }
+
+            // a lost sample leaves a gap, as it does in a log
+            timestamp += 16 + static_cast<int>(random.uniform() * 2);
+            if (random.uniform() < 0.01)
+            {
+                timestamp += 16;
+            }
+
+            sample.timestamp = timestamp;
+            sample.x = targetX + 0.01 * random.gaussian();
+            sample.y = targetY + 0.01 * random.gaussian();
+            sample.fixation = FIXATION::UNKNOWN;
+        }
+    }
+
+    Result evaluate(const Configuration& configuration, const Trace& trace, long long settle, std::vector<GAZE_SAMPLE>& filtered)
+    {
+        Result result;
+        FILTER_HANDLE filter = createFilter(configuration.filter->type, &configuration.parameters);
+        if (filter == nullptr)
+        {
+            result.valid = false;
+            return result;
+        }
+
+        filtered = trace.samples;
+        auto start = Clock::now();
+        filterSamples(filter, filtered.data(), static_cast<int>(filtered.size()));
+        auto end = Clock::now();
+        destroyFilter(filter);
+
+        result.samples = static_cast<long long>(filtered.size());
+        result.nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+
+        // deviations within each fixation are taken from that fixation's own mean
+        for (const Fixation& fixation : trace.fixations)
+        {
+            RunningStats x, y;
+            long long settled = trace.samples[fixation.first].timestamp + settle;
+            for (size_t i = fixation.first; i < fixation.last; i++)
+            {
+                if (filtered[i].timestamp >= settled)
+                {
+                    x.add(filtered[i].x);
+                    y.add(filtered[i].y);
+                }
+            }
+            result.jitterSumSquares += x.sumSquaredDeviations() + y.sumSquaredDeviations();
+            result.jitterCount += x.count();
+        }
+
+        for (const Saccade& saccade : trace.saccades)
+        {
+            double dx = saccade.toX - saccade.fromX;
+            double dy = saccade.toY - saccade.fromY;
+            double amplitudeSquared = dx * dx + dy * dy;
+            long long onsetTime = trace.samples[saccade.onset].timestamp;
+            bool started = false;
+            bool settled = false;
+
+            for (size_t i = saccade.onset; i < saccade.end && !settled; i++)
+            {
+                double progress = ((filtered[i].x - saccade.fromX) * dx + (filtered[i].y - saccade.fromY) * dy) / amplitudeSquared;
+                if (!started && progress >= OnsetProgress)
+                {
+                    result.onset.add(static_cast<double>(filtered[i].timestamp - onsetTime));
+                    started = true;
+                }
+                if (progress >= SettledProgress)
+                {
+                    result.lag.add(static_cast<double>(filtered[i].timestamp - onsetTime));
+                    settled = true;
+                }
+            }
+
+            result.saccades++;
+            if (!settled)
+            {
+                result.unsettled++;
+            }
+        }
+
+        return result;
+    }
+
+    bool parseValues(const char* text, bool integer, std::vector<double>& values)
+    {
+        values.clear();
+        const char* colon = std::strchr(text, ':');
+        char* end = nullptr;
+        if (colon != nullptr)
+        {
+            double start = std::strtod(text, &end);
+            if (end != colon)
+            {
+                return false;
+            }
+            double stop = std::strtod(colon + 1, &end);
+            if (*end != ':')
+            {
+                return false;
+            }
+            double step = std::strtod(end + 1, &end);
+            if (*end != 0 || !(step > 0) || stop < start)
+            {
+                return false;
+            }
+
+            // counted rather than accumulated, so the last value is not lost to rounding
+            long long steps = static_cast<long long>(std::floor((stop - start) / step + 1e-9));
+            for (long long i = 0; i <= steps; i++)
+            {
+                values.push_back(start + i * step);
+            }
+        }
+        else
+        {
+            for (;;)
+            {
+                double value = std::strtod(text, &end);
+                if (end == text || (*end != ',' && *end != 0))
+                {
+                    return false;
+                }
+                values.push_back(value);
+                if (*end == 0)
+                {
+                    break;
+                }
+                text = end + 1;
+            }
+        }
+
+        if (integer)
+        {
+            for (double& value : values)
+            {
+                value = std::round(value);
+            }
+        }
+        return !values.empty();
+    }
+
+    // Every combination of the values of the parameters the filter uses, the first parameter slowest
+    void addConfigurations(const FilterInfo& filter, const std::vector<double> (&values)[PARAMETER_COUNT], std::vector<Configuration>& configurations)
+    {
+        FILTER_PARAMETERS parameters;
+        getDefaultFilterParameters(&parameters);
+
+        std::vector<size_t> index(filter.parameters.size(), 0);
+        for (;;)
+        {
+            for (size_t p = 0; p < filter.parameters.size(); p++)
+            {
+                Parameter parameter = filter.parameters[p];
+                Parameters[parameter].set(parameters, values[parameter][index[p]]);
+            }
+            configurations.push_back({ &filter, parameters });
+
+            size_t p = filter.parameters.size();
+            while (p > 0)
+            {
+                p--;
+                if (++index[p] < values[filter.parameters[p]].size())
+                {
+                    break;
+                }
+                index[p] = 0;
+                if (p == 0)
+                {
+                    return;
+                }
+            }
+            if (filter.parameters.empty())
+            {
+                return;
+            }
+        }
+    }
+
+    std::string describe(const Configuration& configuration, const char* separator)
+    {
+        std::string text;
+        for (Parameter parameter : configuration.filter->parameters)
+        {
+            char value[64];
+            std::snprintf(value, sizeof(value), "%s=%g", Parameters[parameter].name, Parameters[parameter].get(configuration.parameters));
+            if (!text.empty())
+            {
+                text += separator;
+            }
+            text += value;
+        }
+        return text.empty() ? "-" : text;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr,
+            "usage: GazeFilterSweep [--filters Gain,OneEuro,...] [--saccade list] [--gain list] [--history list]\n"
+            "                       [--beta list] [--cutoff list] [--average list] [--radius 0.05] [--settle 200]\n"
+            "                       [--traces 16] [--samples 20000] [--seed n] [--threads n] [--csv] [gaze log ...]\n"
+            "a list is comma separated values or start:stop:step\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<const FilterInfo*> filters;
+    std::vector<double> values[PARAMETER_COUNT];
+    std::vector<std::string> logs;
+    double radius = 0.05;
+    long long settle = 200;
+    int traceCount = 16;
+    int sampleCount = 20000;
+    unsigned long long seed = 1;
+    int threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool parameter = false;
+        for (int p = 0; p < PARAMETER_COUNT; p++)
+        {
+            if (arg == std::string("--") + Parameters[p].name && hasValue)
+            {
+                if (!parseValues(argv[++i], Parameters[p].integer, values[p]))
+                {
+                    usage();
+                    return 2;
+                }
+                parameter = true;
+            }
+        }
+
+        if (parameter)
+        {
+            continue;
+        }
+        else if (arg == "--filters" && hasValue)
+        {
+            std::string names = std::string(argv[++i]) + ",";
+            for (size_t start = 0, comma; (comma = names.find(',', start)) != std::string::npos; start = comma + 1)
+            {
+                std::string name = names.substr(start, comma - start);
+                auto found = std::find_if(std::begin(Filters), std::end(Filters), [&](const FilterInfo& info) { return name == info.name; });
+                if (found == std::end(Filters))
+                {
+                    std::fprintf(stderr, "unknown filter %s\n", name.c_str());
+                    return 2;
+                }
+                filters.push_back(&*found);
+            }
+        }
+        else if (arg == "--radius" && hasValue)
+        {
+            radius = std::atof(argv[++i]);
+        }
+        else if (arg == "--settle" && hasValue)
+        {
+            settle = std::atoll(argv[++i]);
+        }
+        else if (arg == "--traces" && hasValue)
+        {
+            traceCount = std::atoi(argv[++i]);
+        }
+        else if (arg == "--samples" && hasValue)
+        {
+            sampleCount = std::atoi(argv[++i]);
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            threadCount = std::atoi(argv[++i]);
+        }
+        else if (arg == "--csv")
+        {
+            csv = true;
+        }
+        else if (arg.compare(0, 2, "--") != 0)
+        {
+            logs.push_back(arg);
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (!(radius > 0) || traceCount <= 0 || sampleCount <= 0)
+    {
+        usage();
+        return 2;
+    }
+    threadCount = std::max(threadCount, 1);
+
+    if (filters.empty())
+    {
+        for (const FilterInfo& info : Filters)
+        {
+            filters.push_back(&info);
+        }
+    }
+
+    FILTER_PARAMETERS defaults;
+    getDefaultFilterParameters(&defaults);
+    for (int p = 0; p < PARAMETER_COUNT; p++)
+    {
+        if (values[p].empty())
+        {
+            values[p].push_back(Parameters[p].get(defaults));
+        }
+    }
+
+    std::vector<Trace> traces;
+    if (logs.empty())
+    {
+        traces.resize(traceCount);
+        for (int t = 0; t < traceCount; t++)
+        {
+            generate(traces[t], sampleCount, seed + t);
+        }
+    }
+    else
+    {
+        for (const std::string& path : logs)
+        {
+            traces.emplace_back();
+            if (!loadLog(path, traces.back()))
+            {
+                std::fprintf(stderr, "%s is not a gaze log\n", path.c_str());
+                return 1;
+            }
+        }
+    }
+
+    long long totalSamples = 0;
+    long long totalSaccades = 0;
+    for (Trace& trace : traces)
+    {
+        findFixations(trace, radius);
+        totalSamples += static_cast<long long>(trace.samples.size());
+        totalSaccades += static_cast<long long>(trace.saccades.size());
+    }
+
+    std::vector<Configuration> configurations;
+    for (const FilterInfo* filter : filters)
+    {
+        addConfigurations(*filter, values, configurations);
+    }
+
+    // One job per configuration and trace, taken in turn by each thread
+    size_t jobCount = configurations.size() * traces.size();
+    std::vector<Result> results(jobCount);
+    std::atomic<size_t> nextJob(0);
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&]()
+        {
+            std::vector<GAZE_SAMPLE> filtered;
+            for (size_t job; (job = nextJob.fetch_add(1)) < jobCount;)
+            {
+                results[job] = evaluate(configurations[job / traces.size()], traces[job % traces.size()], settle, filtered);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (csv)
+    {
+        std::printf("filter,parameters,jitter,onset ms,onset sd,lag ms,lag sd,unsettled,ns/sample\n");
+    }
+    else
+    {
+        std::printf("%zu traces, %lld samples, %lld saccades; %zu configurations on %d threads in %.2f s\n",
+            traces.size(), totalSamples, totalSaccades, configurations.size(), threadCount, seconds);
+        std::printf("%-13s %-28s %9s %8s %8s %8s %8s %10s %10s\n",
+            "filter", "parameters", "jitter", "onset", "sd", "lag", "sd", "unsettled", "ns/sample");
+    }
+
+    for (size_t c = 0; c < configurations.size(); c++)
+    {
+        Result result;
+        for (size_t t = 0; t < traces.size(); t++)
+        {
+            result.merge(results[c * traces.size() + t]);
+        }
+
+        const Configuration& configuration = configurations[c];
+        if (!result.valid)
+        {
+            std::fprintf(stderr, "%s %s: invalid parameters\n", configuration.filter->name, describe(configuration, " ").c_str());
+            continue;
+        }
+
+        double jitter = result.jitterCount != 0 ? std::sqrt(result.jitterSumSquares / result.jitterCount) : std::nan("");
+        double unsettled = result.saccades != 0 ? 100.0 * result.unsettled / result.saccades : 0;
+        double nanoseconds = result.samples != 0 ? result.nanoseconds / result.samples : 0;
+        if (csv)
+        {
+            std::printf("%s,%s,%.6f,%.1f,%.1f,%.1f,%.1f,%.1f%%,%.2f\n",
+                configuration.filter->name, describe(configuration, " ").c_str(), jitter,
+                result.onset.mean(), result.onset.standardDeviation(),
+                result.lag.mean(), result.lag.standardDeviation(), unsettled, nanoseconds);
+        }
+        else
+        {
+            std::printf("%-13s %-28s %9.5f %8.1f %8.1f %8.1f %8.1f %9.1f%% %10.2f\n",
+                configuration.filter->name, describe(configuration, " ").c_str(), jitter,
+                result.onset.mean(), result.onset.standardDeviation(),
+                result.lag.mean(), result.lag.standardDeviation(), unsettled, nanoseconds);
+        }
+    }
+
+    if (!csv)
+    {
+        std::printf("jitter in screen fractions, onset and lag in milliseconds from the saccade\n");
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef GAZEFILTERSWEEP_RUNNINGSTATS_H
+#define GAZEFILTERSWEEP_RUNNINGSTATS_H
+
+#include <cmath>
+
+/** \brief Count, mean and variance of a stream of values by Welford's method, which stays
+accurate over any number of values where the sum of squares minus the squared sum does not.
+Two sets of statistics can be merged as if all the values had been added to one (Chan et al.),
+so each thread can keep its own and the results combined afterwards.
+*/
+class RunningStats
+{
+public:
+    RunningStats() : _count(0), _mean(0), _sumSquaredDeviations(0) {}
+
+    void add(double value)
+    {
+        _count++;
+        double delta = value - _mean;
+        _mean += delta / _count;
+        _sumSquaredDeviations += delta * (value - _mean);
+    }
+
+    void merge(const RunningStats& other)
+    {
+        if (other._count == 0)
+        {
+            return;
+        }
+        if (_count == 0)
+        {
+            *this = other;
+            return;
+        }
+
+        long long count = _count + other._count;
+        double delta = other._mean - _mean;
+        _mean += delta * other._count / count;
+        _sumSquaredDeviations += other._sumSquaredDeviations + delta * delta * (static_cast<double>(_count) * other._count / count);
+        _count = count;
+    }
+
+    long long count() const { return _count; }
+    double mean() const { return _count != 0 ? _mean : std::nan(""); }
+
+    /** \brief Sum of the squared deviations from the mean.
+    */
+    double sumSquaredDeviations() const { return _sumSquaredDeviations; }
+
+    /** \brief Population variance.
+    */
+    double variance() const { return _count != 0 ? _sumSquaredDeviations / _count : std::nan(""); }
+    double standardDeviation() const { return std::sqrt(variance()); }
+
+private:
+    long long _count;
+    double _mean;
+    double _sumSquaredDeviations;
+};
+
+#endif //GAZEFILTERSWEEP_RUNNINGSTATS_H
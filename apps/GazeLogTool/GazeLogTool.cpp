@@ -0,0 +1,330 @@
+//
+// Inspects and converts gaze logs.
+//
+// GazeLogTool info <gaze log>
+// GazeLogTool dump <gaze log>                    writes the samples as "x, y, timestamp" text
+// GazeLogTool convert <text log> <gaze log>      converts a text log from an earlier version
+// GazeLogTool bench [--records n] [--dir path]   compares writing and reading text and binary logs
+//
+
+#include "GazeLogReader.h"
+#include "GazeLogWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace GazeLog;
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // The tools write faster than any tracker, so wait for room rather than drop samples
+    void writeAll(GazeLogWriter& writer, const GazeLogRecord& record)
+    {
+        while (writer.full())
+        {
+            std::this_thread::yield();
+        }
+        writer.write(record);
+    }
+
+    bool parseTextLine(const char* line, GazeLogRecord& record)
+    {
+        char* end = nullptr;
+        double x = std::strtod(line, &end);
+        if (end == line || *end != ',')
+        {
+            return false;
+        }
+        line = end + 1;
+
+        double y = std::strtod(line, &end);
+        if (end == line || *end != ',')
+        {
+            return false;
+        }
+        line = end + 1;
+
+        long long timestamp = std::strtoll(line, &end, 10);
+        if (end == line)
+        {
+            return false;
+        }
+
+        std::memset(&record, 0, sizeof(record));
+        record.timestamp = timestamp;
+        record.x = x;
+        record.y = y;
+        return true;
+    }
+
+    int info(const char* path)
+    {
+        GazeLogReader reader;
+        if (!reader.open(path))
+        {
+            std::fprintf(stderr, "%s is not a gaze log\n", path);
+            return 1;
+        }
+
+        size_t count = reader.count();
+        size_t deviceData = 0;
+        size_t leftDetected = 0;
+        size_t rightDetected = 0;
+        size_t outOfOrder = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const GazeLogRecord& record = reader[i];
+            if (record.flags & GAZE_LOG_HAS_DEVICE_DATA)
+            {
+                deviceData++;
+                leftDetected += (record.flags & GAZE_LOG_LEFT_EYE_DETECTED) ? 1 : 0;
+                rightDetected += (record.flags & GAZE_LOG_RIGHT_EYE_DETECTED) ? 1 : 0;
+            }
+            if (i > 0 && record.timestamp < reader[i - 1].timestamp)
+            {
+                outOfOrder++;
+            }
+        }
+
+        double durationMs = count > 1 ? static_cast<double>(reader[count - 1].timestamp - reader[0].timestamp) : 0;
+        std::printf("records          %zu\n", count);
+        std::printf("duration         %.1f s\n", durationMs / 1000);
+        std::printf("rate             %.1f Hz\n", durationMs > 0 ? (count - 1) * 1000.0 / durationMs : 0.0);
+        std::printf("out of order     %zu\n", outOfOrder);
+        std::printf("device data      %zu\n", deviceData);
+        if (deviceData > 0)
+        {
+            std::printf("left eye found   %.1f%%\n", 100.0 * leftDetected / deviceData);
+            std::printf("right eye found  %.1f%%\n", 100.0 * rightDetected / deviceData);
+        }
+        return 0;
+    }
+
+    int dump(const char* path)
+    {
+        GazeLogReader reader;
+        if (!reader.open(path))
+        {
+            std::fprintf(stderr, "%s is not a gaze log\n", path);
+            return 1;
+        }
+
+        for (size_t i = 0; i < reader.count(); i++)
+        {
+            const GazeLogRecord& record = reader[i];
+            std::printf("%.17g, %.17g, %" PRId64 "\n", record.x, record.y, record.timestamp);
+        }
+        return 0;
+    }
+
+    int convert(const char* textPath, const char* logPath)
+    {
+        std::ifstream text(textPath);
+        if (!text)
+        {
+            std::fprintf(stderr, "cannot read %s\n", textPath);
+            return 1;
+        }
+
+        GazeLogWriter writer;
+        if (!writer.open(logPath))
+        {
+            std::fprintf(stderr, "cannot create %s\n", logPath);
+            return 1;
+        }
+
+        std::string line;
+        GazeLogRecord record;
+        while (std::getline(text, line))
+        {
+            if (parseTextLine(line.c_str(), record))
+            {
+                writeAll(writer, record);
+            }
+        }
+        writer.close();
+
+        std::printf("%" PRIu64 " records written to %s\n", writer.written(), logPath);
+        return 0;
+    }
+
+    int bench(size_t records, const std::string& directory)
+    {
+        std::string textPath = directory + "/GazeLogBench.txt";
+        std::string logPath = directory + "/GazeLogBench.bin";
+
+        GazeLogRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.flags = GAZE_LOG_HAS_DEVICE_DATA | GAZE_LOG_LEFT_EYE_DETECTED | GAZE_LOG_RIGHT_EYE_DETECTED;
+
+        // Text, the way earlier versions logged: formatted at the end of the session
+        auto start = Clock::now();
+        {
+            std::FILE* text = std::fopen(textPath.c_str(), "w");
+            if (text == nullptr)
+            {
+                std::fprintf(stderr, "cannot create %s\n", textPath.c_str());
+                return 1;
+            }
+            for (size_t i = 0; i < records; i++)
+            {
+                std::fprintf(text, "%.17g, %.17g, %lld\n", 0.5 + 0.25 * std::sin(i * 0.01), 0.5 + 0.25 * std::cos(i * 0.01),
+                    static_cast<long long>(i * 4));
+            }
+            std::fclose(text);
+        }
+        double textWrite = secondsSince(start);
+
+        GazeLogWriter writer;
+        if (!writer.open(logPath))
+        {
+            std::fprintf(stderr, "cannot create %s\n", logPath.c_str());
+            return 1;
+        }
+        double slowestWrite = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < records; i++)
+        {
+            record.timestamp = static_cast<int64_t>(i * 4);
+            record.deviceTimestamp = record.timestamp;
+            record.x = 0.5 + 0.25 * std::sin(i * 0.01);
+            record.y = 0.5 + 0.25 * std::cos(i * 0.01);
+
+            while (writer.full())
+            {
+                std::this_thread::yield();
+            }
+
+            auto writeStart = Clock::now();
+            writer.write(record);
+            slowestWrite = std::max(slowestWrite, secondsSince(writeStart));
+        }
+        writer.close();
+        double binaryWrite = secondsSince(start);
+
+        double textSum = 0;
+        size_t textCount = 0;
+        start = Clock::now();
+        {
+            std::ifstream text(textPath);
+            std::string line;
+            while (std::getline(text, line))
+            {
+                if (parseTextLine(line.c_str(), record))
+                {
+                    textSum += record.x + record.y;
+                    textCount++;
+                }
+            }
+        }
+        double textRead = secondsSince(start);
+
+        double binarySum = 0;
+        size_t binaryCount = 0;
+        start = Clock::now();
+        {
+            GazeLogReader reader;
+            if (!reader.open(logPath))
+            {
+                std::fprintf(stderr, "cannot read %s\n", logPath.c_str());
+                return 1;
+            }
+            for (size_t i = 0; i < reader.count(); i++)
+            {
+                binarySum += reader[i].x + reader[i].y;
+            }
+            binaryCount = reader.count();
+        }
+        double binaryRead = secondsSince(start);
+
+        std::printf("%zu records\n", records);
+        std::printf("%-8s %12s %12s %12s\n", "format", "write s", "read s", "records read");
+        std::printf("%-8s %12.3f %12.3f %12zu\n", "text", textWrite, textRead, textCount);
+        std::printf("%-8s %12.3f %12.3f %12zu\n", "binary", binaryWrite, binaryRead, binaryCount);
+        std::printf("slowest binary write() %.1f us, dropped %" PRIu64 "\n", slowestWrite * 1e6, writer.dropped());
+
+        std::remove(textPath.c_str());
+        std::remove(logPath.c_str());
+
+        if (textCount != records || binaryCount != records || std::fabs(textSum - binarySum) > 1e-6 * records)
+        {
+            std::fprintf(stderr, "text and binary logs differ\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr,
+            "usage: GazeLogTool info <gaze log>\n"
+            "       GazeLogTool dump <gaze log>\n"
+            "       GazeLogTool convert <text log> <gaze log>\n"
+            "       GazeLogTool bench [--records n] [--dir path]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        usage();
+        return 2;
+    }
+
+    std::string command = argv[1];
+    if (command == "info" && argc == 3)
+    {
+        return info(argv[2]);
+    }
+    if (command == "dump" && argc == 3)
+    {
+        return dump(argv[2]);
+    }
+    if (command == "convert" && argc == 4)
+    {
+        return convert(argv[2], argv[3]);
+    }
+    if (command == "bench")
+    {
+        size_t records = 1000000;
+        std::string directory = ".";
+        for (int i = 2; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--records" && hasValue)
+            {
+                records = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+            }
+            else if (arg == "--dir" && hasValue)
+            {
+                directory = argv[++i];
+            }
+            else
+            {
+                usage();
+                return 2;
+            }
+        }
+        return bench(records, directory);
+    }
+
+    usage();
+    return 2;
+}
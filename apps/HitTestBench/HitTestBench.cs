@@ -0,0 +1,257 @@
+//
+// Checks and times the gaze target index over synthetic layouts: keyboards of evenly spaced keys
+// with panels of larger targets drawn over them. Every query is checked against a linear scan of
+// all the targets. Reports the time per query for scattered points and for fixations, where the
+// gaze stays on one target for a while, and the time to update the index after part of the
+// layout moves. Also checks the fixation fast path of GazePointer.GetHitTarget against targets
+// that move without changing size, which does not refresh the index.
+//
+// HitTestBench [--targets 4000] [--queries 1000000] [--seed n]
+//
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using Microsoft.HandsFree.GazePointer;
+
+namespace HitTestBench
+{
+    class Target
+    {
+        public double Left, Top, Right, Bottom;
+        public int Order;
+
+        public bool Contains(double x, double y)
+        {
+            return x >= Left && x < Right && y >= Top && y < Bottom;
+        }
+    }
+
+    class Program
+    {
+        const double ScreenWidth = 3840;
+        const double ScreenHeight = 2160;
+
+        /// <summary>
+        /// Square keys with gaps between them filling the screen, then one panel per hundred keys
+        /// on top, each a few keys wide with its own keys drawn over it.
+        /// </summary>
+        static List<Target> Generate(Random random, int count)
+        {
+            var targets = new List<Target>();
+            int keys = (count * 9) / 10;
+            int columns = (int)Math.Ceiling(Math.Sqrt(keys * ScreenWidth / ScreenHeight));
+            int rows = (keys + columns - 1) / columns;
+            double pitchX = ScreenWidth / columns;
+            double pitchY = ScreenHeight / rows;
+            for (int i = 0; i < keys; i++)
+            {
+                double left = (i % columns) * pitchX;
+                double top = (i / columns) * pitchY;
+                targets.Add(new Target { Left = left + 2, Top = top + 2, Right = left + pitchX - 2, Bottom = top + pitchY - 2 });
+            }
+
+            while (targets.Count < count)
+            {
+                double left = random.NextDouble() * (ScreenWidth - 400);
+                double top = random.NextDouble() * (ScreenHeight - 300);
+                double width = 100 + random.NextDouble() * 300;
+                double height = 80 + random.NextDouble() * 220;
+                targets.Add(new Target { Left = left, Top = top, Right = left + width, Bottom = top + height });
+                for (int i = 0; i < 8 && targets.Count < count; i++)
+                {
+                    double keyLeft = left + random.NextDouble() * (width - 40);
+                    double keyTop = top + random.NextDouble() * (height - 30);
+                    targets.Add(new Target { Left = keyLeft, Top = keyTop, Right = keyLeft + 40, Bottom = keyTop + 30 });
+                }
+            }
+
+            for (int i = 0; i < targets.Count; i++)
+            {
+                targets[i].Order = i;
+            }
+            return targets;
+        }
+
+        static Target FindLinear(List<Target> targets, double x, double y)
+        {
+            Target found = null;
+            foreach (var target in targets)
+            {
+                if (target.Contains(x, y) && (found == null || target.Order > found.Order))
+                {
+                    found = target;
+                }
+            }
+            return found;
+        }
+
+        static void Update(GazeTargetIndex<Target> index, List<Target> targets)
+        {
+            index.BeginUpdate();
+            foreach (var target in targets)
+            {
+                index.Set(target, target.Left, target.Top, target.Right, target.Bottom, target.Order);
+            }
+            index.EndUpdate();
+        }
+
+        static int Main(string[] args)
+        {
+            int count = 4000;
+            int queries = 1000000;
+            int seed = 1;
+            for (int i = 0; i + 1 < args.Length; i += 2)
+            {
+                switch (args[i])
+                {
+                    case "--targets":
+                        count = int.Parse(args[i + 1]);
+                        break;
+                    case "--queries":
+                        queries = int.Parse(args[i + 1]);
+                        break;
+                    case "--seed":
+                        seed = int.Parse(args[i + 1]);
+                        break;
+                    default:
+                        Console.Error.WriteLine("usage: HitTestBench [--targets 4000] [--queries 1000000] [--seed n]");
+                        return 2;
+                }
+            }
+
+            var random = new Random(seed);
+            var targets = Generate(random, count);
+            var index = new GazeTargetIndex<Target>();
+
+            var stopwatch = Stopwatch.StartNew();
+            Update(index, targets);
+            double buildMs = stopwatch.Elapsed.TotalMilliseconds;
+
+            // scattered points
+            var xs = new double[queries];
+            var ys = new double[queries];
+            for (int i = 0; i < queries; i++)
+            {
+                xs[i] = random.NextDouble() * ScreenWidth;
+                ys[i] = random.NextDouble() * ScreenHeight;
+            }
+
+            int mismatches = 0;
+            int checks = Math.Min(queries, 20000);
+            for (int i = 0; i < checks; i++)
+            {
+                mismatches += index.Find(xs[i], ys[i]) == FindLinear(targets, xs[i], ys[i]) ? 0 : 1;
+            }
+
+            stopwatch.Restart();
+            int hits = 0;
+            for (int i = 0; i < queries; i++)
+            {
+                hits += index.Find(xs[i], ys[i]) != null ? 1 : 0;
+            }
+            double scatteredNs = stopwatch.Elapsed.TotalMilliseconds * 1e6 / queries;
+
+            // fixations: 200 samples jittering around a point, then a jump elsewhere
+            for (int i = 0; i < queries; i++)
+            {
+                if (i % 200 == 0)
+                {
+                    xs[i] = random.NextDouble() * ScreenWidth;
+                    ys[i] = random.NextDouble() * ScreenHeight;
+                }
+                else
+                {
+                    xs[i] = xs[i - 1 - (i - 1) % 200] + (random.NextDouble() - 0.5) * 8;
+                    ys[i] = ys[i - 1 - (i - 1) % 200] + (random.NextDouble() - 0.5) * 8;
+                }
+            }
+
+            Target last = null;
+            for (int i = 0; i < checks; i++)
+            {
+                Target found = index.Find(xs[i], ys[i], last);
+                mismatches += found == FindLinear(targets, xs[i], ys[i]) ? 0 : 1;
+                last = found;
+            }
+
+            last = null;
+            stopwatch.Restart();
+            for (int i = 0; i < queries; i++)
+            {
+                last = index.Find(xs[i], ys[i], last);
+            }
+            double fixationNs = stopwatch.Elapsed.TotalMilliseconds * 1e6 / queries;
+
+            // move one target in a hundred, then set the whole layout again
+            foreach (var target in targets)
+            {
+                if (random.Next(100) == 0)
+                {
+                    double dx = (random.NextDouble() - 0.5) * 200;
+                    double dy = (random.NextDouble() - 0.5) * 200;
+                    target.Left += dx;
+                    target.Right += dx;
+                    target.Top += dy;
+                    target.Bottom += dy;
+                }
+            }
+
+            stopwatch.Restart();
+            Update(index, targets);
+            double updateMs = stopwatch.Elapsed.TotalMilliseconds;
+
+            for (int i = 0; i < checks; i++)
+            {
+                double x = random.NextDouble() * ScreenWidth;
+                double y = random.NextDouble() * ScreenHeight;
+                mismatches += index.Find(x, y) == FindLinear(targets, x, y) ? 0 : 1;
+            }
+
+            // a margin, Canvas position or transform moves a target without resizing it, so the
+            // index still has it under the gaze: as in GazePointer.GetHitTarget, the target the
+            // index keeps is only kept while it contains the gaze where it is now drawn
+            int moved = 0;
+            int stale = 0;
+            for (int i = 0; i < checks; i += 200)
+            {
+                Target fixated = index.Find(xs[i], ys[i]);
+                if (fixated == null)
+                {
+                    continue;
+                }
+
+                double dx = fixated.Right - fixated.Left;
+                fixated.Left += dx;
+                fixated.Right += dx;
+
+                Target found = index.Find(xs[i], ys[i], fixated);
+                stale += found == fixated ? 1 : 0;
+                Target hit = (found == fixated && found.Contains(xs[i], ys[i])) ? found : FindLinear(targets, xs[i], ys[i]);
+                mismatches += hit == FindLinear(targets, xs[i], ys[i]) ? 0 : 1;
+
+                fixated.Left -= dx;
+                fixated.Right -= dx;
+                moved++;
+            }
+
+            stopwatch.Restart();
+            for (int i = 0; i < checks; i++)
+            {
+                FindLinear(targets, xs[i], ys[i]);
+            }
+            double linearNs = stopwatch.Elapsed.TotalMilliseconds * 1e6 / checks;
+
+            Console.WriteLine($"{targets.Count} targets, {hits * 100.0 / queries:F0}% of points on a target");
+            Console.WriteLine($"build            {buildMs,10:F3} ms");
+            Console.WriteLine($"update 1% moved  {updateMs,10:F3} ms");
+            Console.WriteLine($"linear scan      {linearNs,10:F1} ns/query");
+            Console.WriteLine($"scattered        {scatteredNs,10:F1} ns/query");
+            Console.WriteLine($"fixations        {fixationNs,10:F1} ns/query");
+            Console.WriteLine($"moved unindexed  {moved,10} targets, {stale} still found by the index");
+            Console.WriteLine($"mismatches       {mismatches,10}");
+
+            return mismatches == 0 ? 0 : 1;
+        }
+    }
+}
@@ -0,0 +1,7 @@
+using System.Reflection;
+
+[assembly: AssemblyTitle("HitTestBench")]
+[assembly: AssemblyProduct("Microsoft.HandsFree.GazePointer")]
+
+[assembly: AssemblyVersion("1.0.0")]
+[assembly: AssemblyFileVersion("1.0.0")]
@@ -0,0 +1,191 @@
+//
+// Drives the simulated IrisbondAPI at a range of sample rates and reports how the
+// data callback keeps up: delivered, dropped and late callbacks, and the delivery
+// delay and time spent in the callback.
+//
+// IrisbondSimBench [--rates 60,250,500,1000] [--seconds 3] [--jitter ms] [--work us]
+//                  [--seed n] [--trace file] [--freerun]
+//
+
+#include "IrisbondSim.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::atomic<long long> _callbackWorkUs{ 0 };
+    std::atomic<long long> _lastTimestamp{ 0 };
+    std::atomic<unsigned long long> _outOfOrder{ 0 };
+
+    void dataCallback(
+        long long timestamp,
+        float /*mouseX*/, float /*mouseY*/,
+        float /*mouseRawX*/, float /*mouseRawY*/,
+        int /*screenWidth*/, int /*screenHeight*/,
+        bool /*leftEyeDetected*/, bool /*rightEyeDetected*/,
+        int /*imageWidth*/, int /*imageHeight*/,
+        float /*leftEyeX*/, float /*leftEyeY*/, float /*leftEyeSize*/,
+        float /*rightEyeX*/, float /*rightEyeY*/, float /*rightEyeSize*/,
+        float /*distanceFactor*/)
+    {
+        if (timestamp < _lastTimestamp.load(std::memory_order_relaxed))
+        {
+            _outOfOrder.fetch_add(1, std::memory_order_relaxed);
+        }
+        _lastTimestamp.store(timestamp, std::memory_order_relaxed);
+
+        // Stand-in for the work a real consumer does per sample
+        long long workUs = _callbackWorkUs.load(std::memory_order_relaxed);
+        if (workUs > 0)
+        {
+            auto until = Clock::now() + std::chrono::microseconds(workUs);
+            while (Clock::now() < until)
+            {
+            }
+        }
+    }
+
+    std::vector<double> parseRates(const char* text)
+    {
+        std::vector<double> rates;
+        while (*text != '\0')
+        {
+            char* end = nullptr;
+            double rate = std::strtod(text, &end);
+            if (end == text)
+            {
+                break;
+            }
+            rates.push_back(rate);
+            text = *end == ',' ? end + 1 : end;
+        }
+        return rates;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr,
+            "usage: IrisbondSimBench [--rates 60,250,500,1000] [--seconds 3] [--jitter ms] [--work us]\n"
+            "                        [--seed n] [--trace file] [--freerun]\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<double> rates = { 60, 250, 500, 1000 };
+    double seconds = 3;
+    double jitterMs = 0;
+    long long workUs = 0;
+    unsigned seed = 1;
+    const char* trace = nullptr;
+    bool freeRun = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--rates" && hasValue)
+        {
+            rates = parseRates(argv[++i]);
+        }
+        else if (arg == "--seconds" && hasValue)
+        {
+            seconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--jitter" && hasValue)
+        {
+            jitterMs = std::atof(argv[++i]);
+        }
+        else if (arg == "--work" && hasValue)
+        {
+            workUs = std::atoll(argv[++i]);
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--trace" && hasValue)
+        {
+            trace = argv[++i];
+        }
+        else if (arg == "--freerun")
+        {
+            freeRun = true;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (rates.empty() || seconds <= 0)
+    {
+        usage();
+        return 2;
+    }
+
+    if (trace != nullptr && !IrisbondSim::loadSimulationTrace(trace))
+    {
+        std::fprintf(stderr, "cannot load trace %s\n", trace);
+        return 1;
+    }
+
+    _callbackWorkUs.store(workUs);
+    IrisbondSim::setSimulationJitter(jitterMs);
+    IrisbondSim::setSimulationSeed(seed);
+    IrisbondSim::setSimulationFreeRun(freeRun);
+    IrisbondAPI::setHighPerformanceMode(true);
+    IrisbondAPI::setDataCallback(dataCallback);
+
+    std::printf("%8s %10s %8s %8s %10s %10s %10s %10s %10s %10s %10s\n",
+        "rate", "delivered", "dropped", "late",
+        "late p50", "late p99", "late max",
+        "cb p50", "cb p99", "cb max", "actual Hz");
+
+    int status = 0;
+    for (double rate : rates)
+    {
+        _lastTimestamp.store(0);
+        _outOfOrder.store(0);
+
+        IrisbondSim::setSimulationRate(rate);
+        if (IrisbondAPI::start() != IrisbondAPI::START_STATUS::START_OK)
+        {
+            std::fprintf(stderr, "simulator failed to start at %g Hz\n", rate);
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        IrisbondAPI::stop();
+
+        IrisbondSim::SIMULATION_STATS stats;
+        IrisbondSim::getSimulationStats(&stats);
+
+        std::printf("%8g %10llu %8llu %8llu %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f %10.1f\n",
+            rate,
+            static_cast<unsigned long long>(stats.delivered),
+            static_cast<unsigned long long>(stats.dropped),
+            static_cast<unsigned long long>(stats.late),
+            stats.latenessP50, stats.latenessP99, stats.latenessMax,
+            stats.callbackP50, stats.callbackP99, stats.callbackMax,
+            stats.effectiveRate);
+
+        if (_outOfOrder.load() != 0)
+        {
+            std::fprintf(stderr, "%llu samples delivered out of order at %g Hz\n", _outOfOrder.load(), rate);
+            status = 1;
+        }
+    }
+
+    std::printf("latencies in microseconds\n");
+    return status;
+}
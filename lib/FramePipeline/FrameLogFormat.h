@@ -0,0 +1,98 @@
+/*! \FrameLogFormat
+ *
+ * Camera frames recorded by the frame pipeline. The file is a FrameLogHeader followed by
+ * frames, each a FrameLogRecord and then dataSize bytes of pixels, rows of cols pixels of
+ * channels bytes each. A log is complete up to its last whole frame even if the writer never
+ * closed it. Gaps in the sequence numbers are frames the pipeline dropped.
+ *
+ * All fields are little endian. The format is defined entirely in this header, so tools can
+ * read frame logs without linking the pipeline.
+ */
+
+#ifndef FRAMEPIPELINE_FRAMELOGFORMAT_H
+#define FRAMEPIPELINE_FRAMELOGFORMAT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace FramePipeline
+{
+    const uint32_t FrameLogMagic = 0x52465A47;  ///< "GZFR"
+    const uint16_t FrameLogVersion = 1;
+
+    struct FrameLogHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t headerSize;
+        uint32_t recordSize;        ///< Size of a FrameLogRecord, not counting its pixels.
+        uint32_t reserved0;
+        int64_t startTime;          ///< When the log was started, as a UTC Windows file time.
+        uint8_t reserved[40];
+    };
+
+    enum FrameLogFlags : uint8_t
+    {
+        FRAME_LOG_MATCHED = 1,              ///< The sample fields were filled in from the matching DATA_CALLBACK.
+        FRAME_LOG_LEFT_EYE_DETECTED = 2,
+        FRAME_LOG_RIGHT_EYE_DETECTED = 4
+    };
+
+    struct FrameLogRecord
+    {
+        int64_t timestamp;          ///< Milliseconds since the epoch.
+        int64_t sequence;
+        int32_t rows;
+        int32_t cols;
+        int32_t channels;
+        uint32_t dataSize;
+        int64_t sampleTimestamp;
+        float x;                    ///< Gaze point in screen pixels.
+        float y;
+        float leftEyeSize;
+        float rightEyeSize;
+        float distanceFactor;
+        uint8_t flags;              ///< FrameLogFlags
+        uint8_t reserved[3];
+    };
+
+    static_assert(sizeof(FrameLogHeader) == 64, "FrameLogHeader must not change size");
+    static_assert(offsetof(FrameLogHeader, startTime) == 16, "FrameLogHeader must not change layout");
+    static_assert(sizeof(FrameLogRecord) == 64, "FrameLogRecord must not change size");
+    static_assert(offsetof(FrameLogRecord, sampleTimestamp) == 32, "FrameLogRecord must not change layout");
+    static_assert(offsetof(FrameLogRecord, flags) == 60, "FrameLogRecord must not change layout");
+
+    /** \brief A header for a log started now.
+    */
+    inline FrameLogHeader makeFrameLogHeader()
+    {
+        // 100 ns intervals between 1601-01-01, the Windows file time epoch, and 1970-01-01
+        const int64_t FileTimeUnixEpoch = 116444736000000000LL;
+
+        FrameLogHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = FrameLogMagic;
+        header.version = FrameLogVersion;
+        header.headerSize = sizeof(FrameLogHeader);
+        header.recordSize = sizeof(FrameLogRecord);
+
+        auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+        header.startTime = FileTimeUnixEpoch +
+            std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count() * 10;
+        return header;
+    }
+
+    /** \brief False if the header is not one this version can read.
+    */
+    inline bool validFrameLogHeader(const FrameLogHeader& header)
+    {
+        return header.magic == FrameLogMagic &&
+               header.version == FrameLogVersion &&
+               header.headerSize == sizeof(FrameLogHeader) &&
+               header.recordSize == sizeof(FrameLogRecord);
+    }
+}
+
+#endif //FRAMEPIPELINE_FRAMELOGFORMAT_H
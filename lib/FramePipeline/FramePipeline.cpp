@@ -0,0 +1,588 @@
+#include "FramePipeline.h"
+#include "FrameLogFormat.h"
+
+#include <cstring>
+#include <new>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace FramePipeline
+{
+    namespace
+    {
+        // The camera thread only wakes the worker when frames are backing up; otherwise it looks
+        // for frames this often.
+        const std::chrono::milliseconds WorkerInterval(2);
+        const std::chrono::milliseconds FlushInterval(100);
+        const size_t FileBufferSize = 1 << 20;
+
+        size_t powerOfTwoAtLeast(size_t value)
+        {
+            size_t result = 1;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        long long distance(long long a, long long b)
+        {
+            return a > b ? a - b : b - a;
+        }
+
+        // The pipeline's threads give way to the tracker's, so that a burst of analysis or
+        // writing never delays a gaze sample
+        void lowerThreadPriority()
+        {
+#ifdef WIN32
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+            setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+        }
+    }
+
+    FRAME_PIPELINE_CONFIG defaultConfig()
+    {
+        FRAME_PIPELINE_CONFIG config;
+        config.slots = 16;
+        config.maxFrameBytes = 1280 * 1024;
+        config.matchToleranceMs = 8;
+        config.matchWaitMs = 20;
+        config.analyze = true;
+        config.darkLevel = 20;
+        config.brightLevel = 250;
+        return config;
+    }
+
+    bool validConfig(const FRAME_PIPELINE_CONFIG& config)
+    {
+        return config.slots > 0 && config.slots <= 4096 &&
+               config.maxFrameBytes > 0 &&
+               config.matchToleranceMs >= 0 &&
+               config.matchWaitMs >= 0;
+    }
+
+    void measureFrame(const unsigned char* data, int rows, int cols, int channels, int darkLevel, int brightLevel, FRAME_METRICS& metrics)
+    {
+        size_t pixels = static_cast<size_t>(rows) * cols;
+        uint64_t sum = 0;
+        int dark = 0;
+        int bright = 0;
+        for (size_t i = 0; i < pixels; i++)
+        {
+            int level = data[i * channels];
+            sum += level;
+            dark += level <= darkLevel ? 1 : 0;
+            bright += level >= brightLevel ? 1 : 0;
+        }
+
+        metrics.meanLevel = pixels != 0 ? static_cast<double>(sum) / pixels : 0;
+        metrics.pupilPixels = dark;
+        metrics.glintPixels = bright;
+    }
+
+    SlotQueue::SlotQueue(size_t capacity)
+        : _ring(new uint32_t[capacity]),
+          _mask(capacity - 1),
+          _head(0),
+          _tail(0)
+    {
+    }
+
+    bool SlotQueue::push(uint32_t slot)
+    {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) > _mask)
+        {
+            return false;
+        }
+
+        _ring[head & _mask] = slot;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool SlotQueue::pop(uint32_t& slot)
+    {
+        uint64_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        slot = _ring[tail & _mask];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::unique_ptr<Pipeline> Pipeline::create(const FRAME_PIPELINE_CONFIG& config)
+    {
+        if (!validConfig(config))
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<Pipeline> pipeline;
+        try
+        {
+            pipeline.reset(new Pipeline(config));
+        }
+        catch (const std::bad_alloc&)
+        {
+            return nullptr;
+        }
+
+        pipeline->_worker = std::thread(&Pipeline::workerLoop, pipeline.get());
+        return pipeline;
+    }
+
+    Pipeline::Pipeline(const FRAME_PIPELINE_CONFIG& config)
+        : _config(config),
+          _slots(new Slot[config.slots]),
+          _nextSlot(0),
+          _sequence(0),
+          _frames(powerOfTwoAtLeast(config.slots)),
+          _toRecord(powerOfTwoAtLeast(config.slots)),
+          _samples(new SampleSlot[SampleRingSize]),
+          _samplesWritten(0),
+          _stopping(false),
+          _queued(0),
+          _processed(0),
+          _callback(nullptr),
+          _callbackContext(nullptr),
+          _recording(false),
+          _file(nullptr),
+          _recorderStopping(false),
+          _received(0),
+          _dropped(0),
+          _matched(0),
+          _unmatched(0),
+          _timedOut(0),
+          _analyzed(0),
+          _withoutPupil(0),
+          _withoutGlint(0),
+          _recorded(0),
+          _recordErrors(0),
+          _bytesRecorded(0)
+    {
+        // Touch every page now, so the first frames do not pay for it on the camera thread
+        for (int i = 0; i < config.slots; i++)
+        {
+            _slots[i].data.reset(new unsigned char[config.maxFrameBytes]);
+            std::memset(_slots[i].data.get(), 0, config.maxFrameBytes);
+        }
+    }
+
+    Pipeline::~Pipeline()
+    {
+        stopRecording();
+
+        {
+            std::lock_guard<std::mutex> lock(_workerMutex);
+            _stopping = true;
+        }
+        _workerWake.notify_one();
+        if (_worker.joinable())
+        {
+            _worker.join();
+        }
+    }
+
+    bool Pipeline::pushFrame(const char* data, int rows, int cols, int channels, long long timestamp)
+    {
+        long long sequence = _sequence++;
+        _received.fetch_add(1, std::memory_order_relaxed);
+
+        long long size = static_cast<long long>(rows) * cols * channels;
+        if (data == nullptr || rows <= 0 || cols <= 0 || channels <= 0 || size > _config.maxFrameBytes)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Slots are nearly always freed in the order they were filled, so the next one is free
+        Slot* slot = nullptr;
+        uint32_t index = _nextSlot;
+        for (int i = 0; i < _config.slots; i++)
+        {
+            if (!_slots[index].busy.load(std::memory_order_acquire))
+            {
+                slot = &_slots[index];
+                break;
+            }
+            index = index + 1 < static_cast<uint32_t>(_config.slots) ? index + 1 : 0;
+        }
+
+        if (slot == nullptr)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slot->busy.store(true, std::memory_order_relaxed);
+        _nextSlot = index + 1 < static_cast<uint32_t>(_config.slots) ? index + 1 : 0;
+
+        std::memcpy(slot->data.get(), data, static_cast<size_t>(size));
+        std::memset(&slot->info, 0, sizeof(slot->info));
+        slot->info.timestamp = timestamp;
+        slot->info.sequence = sequence;
+        slot->info.rows = rows;
+        slot->info.cols = cols;
+        slot->info.channels = channels;
+        slot->arrival = Clock::now();
+
+        // Every slot fits in the queue, so this cannot fail
+        _frames.push(index);
+        _queued.fetch_add(1, std::memory_order_release);
+
+        if (_frames.count() * 2 >= _frames.capacity())
+        {
+            _workerWake.notify_one();
+        }
+        return true;
+    }
+
+    void Pipeline::pushSample(const FRAME_SAMPLE& sample)
+    {
+        uint64_t n = _samplesWritten.load(std::memory_order_relaxed);
+        SampleSlot& slot = _samples[n % SampleRingSize];
+
+        slot.version.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.sample = sample;
+        slot.version.store(2 * n + 2, std::memory_order_release);
+        _samplesWritten.store(n + 1, std::memory_order_release);
+    }
+
+    void Pipeline::setAnalysisCallback(FRAME_ANALYSIS_CALLBACK callback, void* context)
+    {
+        // The worker already holds the lock while it calls the callback, so a callback that
+        // replaces itself sets it directly; the worker only reads it again for the next frame
+        if (std::this_thread::get_id() == _worker.get_id())
+        {
+            _callback = callback;
+            _callbackContext = context;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_callbackMutex);
+        _callback = callback;
+        _callbackContext = context;
+    }
+
+    void Pipeline::workerLoop()
+    {
+        lowerThreadPriority();
+
+        bool stopping = false;
+        while (!stopping)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_workerMutex);
+                _workerWake.wait_for(lock, WorkerInterval);
+                stopping = _stopping;
+            }
+
+            uint32_t index;
+            bool processed = false;
+            while (_frames.pop(index))
+            {
+                process(index);
+                _processed.fetch_add(1, std::memory_order_release);
+                processed = true;
+            }
+
+            if (processed)
+            {
+                std::lock_guard<std::mutex> lock(_workerMutex);
+                _workerIdle.notify_all();
+            }
+        }
+    }
+
+    void Pipeline::waitForWorker()
+    {
+        // The analysis callback runs on the worker, which cannot wait for itself
+        if (std::this_thread::get_id() == _worker.get_id())
+        {
+            return;
+        }
+
+        uint64_t queued = _queued.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(_workerMutex);
+        _workerWake.notify_one();
+        _workerIdle.wait(lock, [this, queued] { return _processed.load(std::memory_order_acquire) >= queued || _stopping; });
+    }
+
+    void Pipeline::process(uint32_t index)
+    {
+        Slot& slot = _slots[index];
+        FRAME_INFO& info = slot.info;
+
+        // The sample for a frame normally follows it within a millisecond or so; only wait for
+        // it if samples are arriving at all. A sample that has not come by the time the next
+        // frame is queued is most likely lost, and waiting longer only holds up that frame.
+        auto waitUntil = slot.arrival + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(_config.matchWaitMs));
+        while (_samplesWritten.load(std::memory_order_acquire) != 0 &&
+               newestSampleTimestamp() < info.timestamp)
+        {
+            if (_frames.count() != 0 || Clock::now() >= waitUntil)
+            {
+                _timedOut.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        info.matched = findSample(info.timestamp, info.sample);
+        (info.matched ? _matched : _unmatched).fetch_add(1, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(_callbackMutex);
+            if (_config.analyze || _callback != nullptr)
+            {
+                FRAME_METRICS metrics;
+                measureFrame(slot.data.get(), info.rows, info.cols, info.channels, _config.darkLevel, _config.brightLevel, metrics);
+                _analyzed.fetch_add(1, std::memory_order_relaxed);
+                if (metrics.pupilPixels == 0)
+                {
+                    _withoutPupil.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (metrics.glintPixels == 0)
+                {
+                    _withoutGlint.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                if (_callback != nullptr)
+                {
+                    _callback(&info, &metrics, slot.data.get(), _callbackContext);
+                }
+            }
+        }
+
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(_recordMutex);
+            if (_recording)
+            {
+                queued = _toRecord.push(index);
+            }
+        }
+
+        if (queued)
+        {
+            _recorderWake.notify_one();
+        }
+        else
+        {
+            release(slot);
+        }
+    }
+
+    long long Pipeline::newestSampleTimestamp() const
+    {
+        FRAME_SAMPLE sample;
+        uint64_t written = _samplesWritten.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const SampleSlot& slot = _samples[(written - 1) % SampleRingSize];
+            uint64_t version = slot.version.load(std::memory_order_acquire);
+            sample = slot.sample;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == version && version == 2 * written)
+            {
+                return sample.timestamp;
+            }
+
+            // overwritten while it was read; the newer sample is newer still
+            written = _samplesWritten.load(std::memory_order_acquire);
+        }
+    }
+
+    bool Pipeline::findSample(long long timestamp, FRAME_SAMPLE& found) const
+    {
+        long long tolerance = static_cast<long long>(_config.matchToleranceMs);
+        long long bestDistance = tolerance + 1;
+        uint64_t written = _samplesWritten.load(std::memory_order_acquire);
+        uint64_t oldest = written > SampleRingSize ? written - SampleRingSize : 0;
+
+        // Newest first, stopping at samples too old to match or overwritten while being read
+        for (uint64_t n = written; n > oldest; n--)
+        {
+            const SampleSlot& slot = _samples[(n - 1) % SampleRingSize];
+            uint64_t version = slot.version.load(std::memory_order_acquire);
+            FRAME_SAMPLE sample = slot.sample;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version != 2 * n || slot.version.load(std::memory_order_relaxed) != version)
+            {
+                break;
+            }
+
+            long long d = distance(sample.timestamp, timestamp);
+            if (d < bestDistance)
+            {
+                bestDistance = d;
+                found = sample;
+            }
+            if (sample.timestamp < timestamp - tolerance)
+            {
+                break;
+            }
+        }
+
+        if (bestDistance > tolerance)
+        {
+            std::memset(&found, 0, sizeof(found));
+            return false;
+        }
+        return true;
+    }
+
+    bool Pipeline::startRecording(const std::string& path)
+    {
+        stopRecording();
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        _fileBuffer.reset(new char[FileBufferSize]);
+        std::setvbuf(file, _fileBuffer.get(), _IOFBF, FileBufferSize);
+
+        FrameLogHeader header = makeFrameLogHeader();
+        if (std::fwrite(&header, sizeof(header), 1, file) != 1 || std::fflush(file) != 0)
+        {
+            std::fclose(file);
+            return false;
+        }
+        _bytesRecorded.fetch_add(sizeof(header), std::memory_order_relaxed);
+
+        _file = file;
+        _recorderStopping = false;
+        _recorder = std::thread(&Pipeline::recorderLoop, this);
+
+        std::lock_guard<std::mutex> lock(_recordMutex);
+        _recording = true;
+        return true;
+    }
+
+    void Pipeline::stopRecording()
+    {
+        // Frames still waiting for their sample would otherwise be released instead of written
+        waitForWorker();
+
+        {
+            std::lock_guard<std::mutex> lock(_recordMutex);
+            _recording = false;
+        }
+
+        if (!_recorder.joinable())
+        {
+            return;
+        }
+
+        // The worker queues nothing more, so the recorder can finish what is queued and stop
+        {
+            std::lock_guard<std::mutex> lock(_recorderMutex);
+            _recorderStopping = true;
+        }
+        _recorderWake.notify_one();
+        _recorder.join();
+
+        std::fclose(_file);
+        _file = nullptr;
+    }
+
+    void Pipeline::recorderLoop()
+    {
+        lowerThreadPriority();
+
+        auto lastFlush = Clock::now();
+        bool stopping = false;
+        while (!stopping)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_recorderMutex);
+                _recorderWake.wait_for(lock, FlushInterval);
+                stopping = _recorderStopping;
+            }
+
+            uint32_t index;
+            while (_toRecord.pop(index))
+            {
+                writeFrame(_slots[index]);
+                release(_slots[index]);
+            }
+
+            // Hand the data to the operating system, so that it survives the process
+            if (Clock::now() - lastFlush >= FlushInterval || stopping)
+            {
+                std::fflush(_file);
+                lastFlush = Clock::now();
+            }
+        }
+    }
+
+    void Pipeline::writeFrame(const Slot& slot)
+    {
+        const FRAME_INFO& info = slot.info;
+
+        FrameLogRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.timestamp = info.timestamp;
+        record.sequence = info.sequence;
+        record.rows = info.rows;
+        record.cols = info.cols;
+        record.channels = info.channels;
+        record.dataSize = static_cast<uint32_t>(info.rows) * info.cols * info.channels;
+        if (info.matched)
+        {
+            record.flags |= FRAME_LOG_MATCHED;
+            record.flags |= info.sample.leftEyeDetected ? FRAME_LOG_LEFT_EYE_DETECTED : 0;
+            record.flags |= info.sample.rightEyeDetected ? FRAME_LOG_RIGHT_EYE_DETECTED : 0;
+            record.sampleTimestamp = info.sample.timestamp;
+            record.x = info.sample.x;
+            record.y = info.sample.y;
+            record.leftEyeSize = info.sample.leftEyeSize;
+            record.rightEyeSize = info.sample.rightEyeSize;
+            record.distanceFactor = info.sample.distanceFactor;
+        }
+
+        // The pixels go to the file straight from the slot
+        if (std::fwrite(&record, sizeof(record), 1, _file) == 1 &&
+            std::fwrite(slot.data.get(), 1, record.dataSize, _file) == record.dataSize)
+        {
+            _recorded.fetch_add(1, std::memory_order_relaxed);
+            _bytesRecorded.fetch_add(sizeof(record) + record.dataSize, std::memory_order_relaxed);
+        }
+        else
+        {
+            _recordErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Pipeline::getStats(FRAME_PIPELINE_STATS& stats) const
+    {
+        stats.received = _received.load(std::memory_order_relaxed);
+        stats.dropped = _dropped.load(std::memory_order_relaxed);
+        stats.matched = _matched.load(std::memory_order_relaxed);
+        stats.unmatched = _unmatched.load(std::memory_order_relaxed);
+        stats.timedOut = _timedOut.load(std::memory_order_relaxed);
+        stats.analyzed = _analyzed.load(std::memory_order_relaxed);
+        stats.withoutPupil = _withoutPupil.load(std::memory_order_relaxed);
+        stats.withoutGlint = _withoutGlint.load(std::memory_order_relaxed);
+        stats.recorded = _recorded.load(std::memory_order_relaxed);
+        stats.recordErrors = _recordErrors.load(std::memory_order_relaxed);
+        stats.bytesRecorded = _bytesRecorded.load(std::memory_order_relaxed);
+    }
+}
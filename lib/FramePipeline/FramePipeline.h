@@ -0,0 +1,165 @@
+#ifndef FRAMEPIPELINE_FRAMEPIPELINE_H
+#define FRAMEPIPELINE_FRAMEPIPELINE_H
+
+#include "FramePipelineAPI.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace FramePipeline
+{
+    FRAME_PIPELINE_CONFIG defaultConfig();
+
+    /** \brief False if a pipeline cannot be created with the configuration.
+    */
+    bool validConfig(const FRAME_PIPELINE_CONFIG& config);
+
+    /** \brief Measure the first channel of a frame.
+    */
+    void measureFrame(const unsigned char* data, int rows, int cols, int channels, int darkLevel, int brightLevel, FRAME_METRICS& metrics);
+
+    /** \brief Lock-free queue of slot numbers between one producer thread and one consumer thread.
+    */
+    class SlotQueue
+    {
+    public:
+        /** \brief capacity must be a power of two.
+        */
+        explicit SlotQueue(size_t capacity);
+
+        bool push(uint32_t slot);
+        bool pop(uint32_t& slot);
+        size_t count() const { return static_cast<size_t>(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire)); }
+        size_t capacity() const { return _mask + 1; }
+
+    private:
+        std::unique_ptr<uint32_t[]> _ring;
+        size_t _mask;
+        alignas(64) std::atomic<uint64_t> _head;
+        alignas(64) std::atomic<uint64_t> _tail;
+    };
+
+    /** \brief The pipeline behind a FRAME_PIPELINE_HANDLE. Each slot is owned by one stage at a
+    time: pushFrame() fills a free slot and queues it for the worker, the worker queues it for
+    the writer while recording, and whichever stage is last frees it.
+    */
+    class Pipeline
+    {
+    public:
+        /** \brief Null if the configuration is invalid or the slots cannot be allocated.
+        */
+        static std::unique_ptr<Pipeline> create(const FRAME_PIPELINE_CONFIG& config);
+
+        ~Pipeline();
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        bool pushFrame(const char* data, int rows, int cols, int channels, long long timestamp);
+        void pushSample(const FRAME_SAMPLE& sample);
+
+        /** \brief Once this returns the previous callback is no longer running and will not be called again.
+        Called from the callback, on the worker, it takes effect from the next frame instead.
+        */
+        void setAnalysisCallback(FRAME_ANALYSIS_CALLBACK callback, void* context);
+
+        bool startRecording(const std::string& path);
+
+        /** \brief Wait for the worker to take every frame already pushed, write out those it queued
+        for recording and close the log. Also waits when not recording, so the counters are complete.
+        */
+        void stopRecording();
+
+        void getStats(FRAME_PIPELINE_STATS& stats) const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        static const size_t SampleRingSize = 256;
+
+        struct Slot
+        {
+            FRAME_INFO info;
+            Clock::time_point arrival;
+            std::unique_ptr<unsigned char[]> data;
+            std::atomic<bool> busy{ false };
+        };
+
+        // Written by the sample thread, read by the worker. version is 2n + 1 while sample n is
+        // being written into the slot and 2n + 2 once it is complete.
+        struct SampleSlot
+        {
+            std::atomic<uint64_t> version{ 0 };
+            FRAME_SAMPLE sample;
+        };
+
+        explicit Pipeline(const FRAME_PIPELINE_CONFIG& config);
+
+        void workerLoop();
+        void waitForWorker();
+        void process(uint32_t index);
+        bool findSample(long long timestamp, FRAME_SAMPLE& found) const;
+        long long newestSampleTimestamp() const;
+
+        void recorderLoop();
+        void writeFrame(const Slot& slot);
+
+        void release(Slot& slot) { slot.busy.store(false, std::memory_order_release); }
+
+        FRAME_PIPELINE_CONFIG _config;
+        std::unique_ptr<Slot[]> _slots;
+        uint32_t _nextSlot;
+        long long _sequence;
+
+        SlotQueue _frames;
+        SlotQueue _toRecord;
+
+        std::unique_ptr<SampleSlot[]> _samples;
+        std::atomic<uint64_t> _samplesWritten;
+
+        std::thread _worker;
+        std::mutex _workerMutex;
+        std::condition_variable _workerWake;
+        std::condition_variable _workerIdle;
+        bool _stopping;
+
+        // Frames queued for the worker, and frames it has finished with
+        std::atomic<uint64_t> _queued;
+        std::atomic<uint64_t> _processed;
+
+        std::mutex _callbackMutex;
+        FRAME_ANALYSIS_CALLBACK _callback;
+        void* _callbackContext;
+
+        // _recording is only changed, and only read by the worker, with _recordMutex held
+        std::mutex _recordMutex;
+        bool _recording;
+        std::FILE* _file;
+        std::unique_ptr<char[]> _fileBuffer;
+        std::thread _recorder;
+        std::mutex _recorderMutex;
+        std::condition_variable _recorderWake;
+        bool _recorderStopping;
+
+        std::atomic<uint64_t> _received;
+        std::atomic<uint64_t> _dropped;
+        std::atomic<uint64_t> _matched;
+        std::atomic<uint64_t> _unmatched;
+        std::atomic<uint64_t> _timedOut;
+        std::atomic<uint64_t> _analyzed;
+        std::atomic<uint64_t> _withoutPupil;
+        std::atomic<uint64_t> _withoutGlint;
+        std::atomic<uint64_t> _recorded;
+        std::atomic<uint64_t> _recordErrors;
+        std::atomic<uint64_t> _bytesRecorded;
+    };
+}
+
+#endif //FRAMEPIPELINE_FRAMEPIPELINE_H
@@ -0,0 +1,80 @@
+//
+// C interface over FramePipeline.h. Handles are the C++ pipeline objects.
+//
+
+#include "FramePipeline.h"
+
+extern "C" {
+    namespace FramePipeline
+    {
+        FRAMEPIPELINE_API void getDefaultFramePipelineConfig(FRAME_PIPELINE_CONFIG* config)
+        {
+            if (config != nullptr)
+            {
+                *config = defaultConfig();
+            }
+        }
+
+        FRAMEPIPELINE_API FRAME_PIPELINE_HANDLE createFramePipeline(const FRAME_PIPELINE_CONFIG* config)
+        {
+            return Pipeline::create(config != nullptr ? *config : defaultConfig()).release();
+        }
+
+        FRAMEPIPELINE_API void destroyFramePipeline(FRAME_PIPELINE_HANDLE pipeline)
+        {
+            delete static_cast<Pipeline*>(pipeline);
+        }
+
+        FRAMEPIPELINE_API bool pushFrame(FRAME_PIPELINE_HANDLE pipeline, const char* data, int rows, int cols, int channels, long long timestamp)
+        {
+            return pipeline != nullptr && static_cast<Pipeline*>(pipeline)->pushFrame(data, rows, cols, channels, timestamp);
+        }
+
+        FRAMEPIPELINE_API void pushFrameSample(FRAME_PIPELINE_HANDLE pipeline, long long timestamp, float x, float y,
+            bool leftEyeDetected, bool rightEyeDetected, float leftEyeSize, float rightEyeSize, float distanceFactor)
+        {
+            if (pipeline != nullptr)
+            {
+                FRAME_SAMPLE sample;
+                sample.timestamp = timestamp;
+                sample.x = x;
+                sample.y = y;
+                sample.leftEyeSize = leftEyeSize;
+                sample.rightEyeSize = rightEyeSize;
+                sample.distanceFactor = distanceFactor;
+                sample.leftEyeDetected = leftEyeDetected;
+                sample.rightEyeDetected = rightEyeDetected;
+                static_cast<Pipeline*>(pipeline)->pushSample(sample);
+            }
+        }
+
+        FRAMEPIPELINE_API void setFrameAnalysisCallback(FRAME_PIPELINE_HANDLE pipeline, FRAME_ANALYSIS_CALLBACK callback, void* context)
+        {
+            if (pipeline != nullptr)
+            {
+                static_cast<Pipeline*>(pipeline)->setAnalysisCallback(callback, context);
+            }
+        }
+
+        FRAMEPIPELINE_API bool startFrameRecording(FRAME_PIPELINE_HANDLE pipeline, const char* path)
+        {
+            return pipeline != nullptr && path != nullptr && static_cast<Pipeline*>(pipeline)->startRecording(path);
+        }
+
+        FRAMEPIPELINE_API void stopFrameRecording(FRAME_PIPELINE_HANDLE pipeline)
+        {
+            if (pipeline != nullptr)
+            {
+                static_cast<Pipeline*>(pipeline)->stopRecording();
+            }
+        }
+
+        FRAMEPIPELINE_API void getFramePipelineStats(FRAME_PIPELINE_HANDLE pipeline, FRAME_PIPELINE_STATS* stats)
+        {
+            if (pipeline != nullptr && stats != nullptr)
+            {
+                static_cast<Pipeline*>(pipeline)->getStats(*stats);
+            }
+        }
+    }
+}
@@ -0,0 +1,156 @@
+/*! \FramePipelineAPI
+ *
+ * Takes the camera frames delivered to the IrisbondAPI IMAGE_CALLBACK off the tracker's thread.
+ * pushFrame() copies a frame once into a slot of a ring preallocated when the pipeline is
+ * created and returns; it never allocates, locks or waits. If every slot is still in use the
+ * frame is dropped and counted, so a slow disk or analysis never holds up gaze delivery.
+ *
+ * A worker thread ties each frame to the DATA_CALLBACK sample with the same timestamp, passed
+ * in through pushFrameSample(), measures it and hands it to the analysis callback. While
+ * recording, the frame then goes to a writer thread that appends it, straight from its slot,
+ * to a frame log (FrameLogFormat.h).
+ */
+
+#ifndef FRAMEPIPELINEAPI_H
+#define FRAMEPIPELINEAPI_H
+
+#ifdef WIN32
+    #ifdef FramePipeline_STATIC
+        #define FRAMEPIPELINE_API
+    #elif defined FramePipeline_EXPORTS
+        #define FRAMEPIPELINE_API __declspec(dllexport)
+    #else
+        #define FRAMEPIPELINE_API __declspec(dllimport)
+    #endif
+#else
+    #define FRAMEPIPELINE_API __attribute__((visibility("default")))
+#endif
+
+namespace FramePipeline
+{
+    /** \brief Pipeline configuration. getDefaultFramePipelineConfig() fills in the defaults.
+    */
+    struct FRAME_PIPELINE_CONFIG
+    {
+        int slots;                  ///< Frames that can be in the pipeline at once. Default 16.
+        int maxFrameBytes;          ///< Largest frame accepted, rows * cols * channels. Default 1280 * 1024.
+        double matchToleranceMs;    ///< Furthest a sample's timestamp may be from the frame's to match it. Default 8.
+        double matchWaitMs;         ///< Longest the worker waits for a frame's sample to arrive, less if the next frame comes first. Default 20.
+        bool analyze;               ///< Measure every frame even without an analysis callback. Default true.
+        int darkLevel;              ///< Pixels at or below this level count as pupil. Default 20.
+        int brightLevel;            ///< Pixels at or above this level count as glint. Default 250.
+    };
+
+    /** \brief The DATA_CALLBACK values kept with a frame.
+    */
+    struct FRAME_SAMPLE
+    {
+        long long timestamp;        ///< Milliseconds since the epoch, as passed to DATA_CALLBACK.
+        float x;                    ///< Gaze point in screen pixels.
+        float y;
+        float leftEyeSize;
+        float rightEyeSize;
+        float distanceFactor;
+        bool leftEyeDetected;
+        bool rightEyeDetected;
+    };
+
+    /** \brief One frame as seen by the analysis callback.
+    */
+    struct FRAME_INFO
+    {
+        long long timestamp;        ///< Milliseconds since the epoch, as passed to IMAGE_CALLBACK.
+        long long sequence;         ///< Counts every frame received, including dropped ones.
+        int rows;
+        int cols;
+        int channels;
+        bool matched;               ///< False if no sample arrived within the tolerance; sample is then zero.
+        FRAME_SAMPLE sample;
+    };
+
+    /** \brief Measurements of the first channel of a frame, for spotting tracking dropouts.
+    */
+    struct FRAME_METRICS
+    {
+        double meanLevel;           ///< Average pixel level, 0 to 255. Low or high for an under or over exposed image.
+        int pupilPixels;            ///< Pixels at or below the dark level.
+        int glintPixels;            ///< Pixels at or above the bright level.
+    };
+
+    /** \brief Counters since the pipeline was created.
+    */
+    struct FRAME_PIPELINE_STATS
+    {
+        unsigned long long received;        ///< Frames passed to pushFrame().
+        unsigned long long dropped;         ///< Frames dropped because every slot was in use or the frame was too large.
+        unsigned long long matched;         ///< Frames tied to a sample.
+        unsigned long long unmatched;       ///< Frames for which no sample arrived within the tolerance.
+        unsigned long long timedOut;        ///< Frames whose sample had not arrived when the worker stopped waiting. Also counted as matched or unmatched.
+        unsigned long long analyzed;        ///< Frames measured.
+        unsigned long long withoutPupil;    ///< Frames measured with no pupil pixels.
+        unsigned long long withoutGlint;    ///< Frames measured with no glint pixels.
+        unsigned long long recorded;        ///< Frames written to the frame log.
+        unsigned long long recordErrors;    ///< Frames that could not be written.
+        unsigned long long bytesRecorded;   ///< Bytes written to the frame log, headers included.
+    };
+
+    /** \brief Called on the pipeline's worker thread for every frame. The data is only valid for
+    the duration of the call, and the next frame waits until it returns.
+    */
+    typedef void(*FRAME_ANALYSIS_CALLBACK)(const FRAME_INFO* frame, const FRAME_METRICS* metrics, const unsigned char* data, void* context);
+
+    typedef void* FRAME_PIPELINE_HANDLE;
+}
+
+extern "C" {
+    namespace FramePipeline
+    {
+        /** \brief Fill in the default configuration.
+        */
+        FRAMEPIPELINE_API void getDefaultFramePipelineConfig(FRAME_PIPELINE_CONFIG* config);
+
+        /** \brief Create a pipeline, allocating all its slots, and start its worker thread.
+        \param[in] config   The configuration, or null for the defaults.
+        \return The pipeline, or null if the configuration is invalid or the slots cannot be allocated.
+        */
+        FRAMEPIPELINE_API FRAME_PIPELINE_HANDLE createFramePipeline(const FRAME_PIPELINE_CONFIG* config);
+
+        /** \brief Stop recording, finish the frames in the pipeline and destroy it.
+        */
+        FRAMEPIPELINE_API void destroyFramePipeline(FRAME_PIPELINE_HANDLE pipeline);
+
+        /** \brief Hand a frame to the pipeline. Call from the IMAGE_CALLBACK; frames must come from one thread.
+        \param[in] data         The frame, rows * cols * channels bytes. Only read during the call.
+        \return False if the frame was dropped.
+        */
+        FRAMEPIPELINE_API bool pushFrame(FRAME_PIPELINE_HANDLE pipeline, const char* data, int rows, int cols, int channels, long long timestamp);
+
+        /** \brief Hand the pipeline a sample to tie to the frame with the same timestamp. Call from the
+        DATA_CALLBACK; samples must come from one thread.
+        */
+        FRAMEPIPELINE_API void pushFrameSample(FRAME_PIPELINE_HANDLE pipeline, long long timestamp, float x, float y,
+            bool leftEyeDetected, bool rightEyeDetected, float leftEyeSize, float rightEyeSize, float distanceFactor);
+
+        /** \brief Set the function called for every frame, or null for none. May be called from the
+        callback itself, in which case the new callback is used from the next frame.
+        */
+        FRAMEPIPELINE_API void setFrameAnalysisCallback(FRAME_PIPELINE_HANDLE pipeline, FRAME_ANALYSIS_CALLBACK callback, void* context);
+
+        /** \brief Start writing frames to a new frame log, replacing any existing file.
+        \return False if the file cannot be created.
+        */
+        FRAMEPIPELINE_API bool startFrameRecording(FRAME_PIPELINE_HANDLE pipeline, const char* path);
+
+        /** \brief Wait for the pipeline to finish with every frame already pushed, write out those
+        being recorded and close the frame log. Waits even when not recording, so the counters
+        include every frame pushed before the call.
+        */
+        FRAMEPIPELINE_API void stopFrameRecording(FRAME_PIPELINE_HANDLE pipeline);
+
+        /** \brief Get the counters.
+        */
+        FRAMEPIPELINE_API void getFramePipelineStats(FRAME_PIPELINE_HANDLE pipeline, FRAME_PIPELINE_STATS* stats);
+    }
+}
+
+#endif //FRAMEPIPELINEAPI_H
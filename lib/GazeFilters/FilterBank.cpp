@@ -0,0 +1,335 @@
+#include "GazeFilters.h"
+#include "Kernels.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+    #define RESTRICT __restrict
+    #define NOINLINE __declspec(noinline)
+#else
+    #define RESTRICT __restrict__
+    #define NOINLINE __attribute__((noinline))
+#endif
+
+//
+// Each bank keeps one array per state field, indexed by stream. The recursive filters cannot be
+// vectorized along a stream, since every sample depends on the one before it, but the streams are
+// independent, so each update is a single loop over the streams that the compiler turns into SIMD.
+//
+
+namespace GazeFilters
+{
+    namespace
+    {
+        // The loops over the streams. They take every array as a restrict parameter, since otherwise
+        // the loops need a run time alias check per pair of arrays, and they are kept out of line
+        // because the restrict qualifiers do not survive the loops being inlined into update().
+
+        NOINLINE void gainStreams(int streams, double saccadeDistance, double gain,
+            double* RESTRICT x, double* RESTRICT y, double* RESTRICT filteredX, double* RESTRICT filteredY,
+            FIXATION* RESTRICT fixation)
+        {
+            for (int i = 0; i < streams; i++)
+            {
+                Kernels::gain(saccadeDistance, gain, x[i], y[i], filteredX[i], filteredY[i], fixation[i]);
+            }
+        }
+
+        NOINLINE void oneEuroStreams(int streams, double beta, double cutoff, const double* RESTRICT timestamp,
+            double* RESTRICT x, double* RESTRICT y, double* RESTRICT lastTimestamp,
+            double* RESTRICT pointX, double* RESTRICT pointY, double* RESTRICT velocityX, double* RESTRICT velocityY,
+            FIXATION* RESTRICT fixation)
+        {
+            for (int i = 0; i < streams; i++)
+            {
+                Kernels::oneEuro(beta, cutoff, timestamp[i], x[i], y[i],
+                    lastTimestamp[i], pointX[i], pointY[i], velocityX[i], velocityY[i], fixation[i]);
+            }
+        }
+
+        NOINLINE void kalmanStreams(int streams, double* RESTRICT x, double* RESTRICT y,
+            double* RESTRICT filteredX, double* RESTRICT filteredY,
+            double* RESTRICT estimateCovarianceX, double* RESTRICT estimateCovarianceY)
+        {
+            for (int i = 0; i < streams; i++)
+            {
+                Kernels::kalman(x[i], y[i], filteredX[i], filteredY[i], estimateCovarianceX[i], estimateCovarianceY[i]);
+            }
+        }
+
+        NOINLINE void averageStreams(int streams, bool full, int count, double* RESTRICT x, double* RESTRICT y,
+            double* RESTRICT oldestX, double* RESTRICT oldestY, double* RESTRICT sumX, double* RESTRICT sumY)
+        {
+            for (int i = 0; i < streams; i++)
+            {
+                Kernels::average(x[i], y[i], oldestX[i], oldestY[i], sumX[i], sumY[i], full, count);
+            }
+        }
+
+        class NullFilterBank : public FilterBank
+        {
+        public:
+            explicit NullFilterBank(int streams) : FilterBank(streams) {}
+
+            void reset() override {}
+            void update(const long long* /*timestamps*/, double* /*x*/, double* /*y*/, FIXATION* /*fixation*/) override {}
+        };
+
+        class GainFilterBank : public FilterBank
+        {
+        public:
+            GainFilterBank(const FILTER_PARAMETERS& parameters, int streams)
+                : FilterBank(streams),
+                  _saccadeDistance(parameters.saccadeDistance),
+                  _gain(parameters.gain),
+                  _filteredX(streams),
+                  _filteredY(streams),
+                  _fixation(streams)
+            {
+                reset();
+            }
+
+            void reset() override
+            {
+                std::fill(_filteredX.begin(), _filteredX.end(), 0.0);
+                std::fill(_filteredY.begin(), _filteredY.end(), 0.0);
+            }
+
+            void update(const long long* /*timestamps*/, double* x, double* y, FIXATION* fixation) override
+            {
+                gainStreams(_streams, _saccadeDistance, _gain, x, y, _filteredX.data(), _filteredY.data(),
+                    fixation != nullptr ? fixation : _fixation.data());
+            }
+
+        private:
+            double _saccadeDistance;
+            double _gain;
+            std::vector<double> _filteredX;
+            std::vector<double> _filteredY;
+
+            // written in place of the caller's fixation states when it does not want them
+            std::vector<FIXATION> _fixation;
+        };
+
+        class StampeFilterBank : public FilterBank
+        {
+        public:
+            StampeFilterBank(const FILTER_PARAMETERS& parameters, int streams)
+                : FilterBank(streams),
+                  _saccadeDistance(parameters.saccadeDistance),
+                  _historyLength(parameters.historyLength),
+                  _values(2 * static_cast<size_t>(streams) * (parameters.historyLength + 1)),
+                  _counts(2 * static_cast<size_t>(streams) * (parameters.historyLength + 1)),
+                  _scratch(parameters.historyLength + 1),
+                  _historyX(streams),
+                  _historyY(streams),
+                  _fixation(streams)
+            {
+                const size_t capacity = static_cast<size_t>(_historyLength) + 1;
+                for (int i = 0; i < streams; i++)
+                {
+                    _historyX[i].values = _values.data() + (2 * i) * capacity;
+                    _historyX[i].counts = _counts.data() + (2 * i) * capacity;
+                    _historyY[i].values = _values.data() + (2 * i + 1) * capacity;
+                    _historyY[i].counts = _counts.data() + (2 * i + 1) * capacity;
+                }
+                reset();
+            }
+
+            void reset() override
+            {
+                for (int i = 0; i < _streams; i++)
+                {
+                    Kernels::resetStampeHistory(_historyX[i], _historyLength);
+                    Kernels::resetStampeHistory(_historyY[i], _historyLength);
+                }
+            }
+
+            // The history adjustment is data dependent, so this one runs a stream at a time over the
+            // run-length history, which costs O(1) amortized per sample
+            void update(const long long* /*timestamps*/, double* x, double* y, FIXATION* fixation) override
+            {
+                FIXATION* state = fixation != nullptr ? fixation : _fixation.data();
+                for (int i = 0; i < _streams; i++)
+                {
+                    Kernels::stampe(_saccadeDistance, _historyLength, _historyX[i], _historyY[i], _scratch.data(),
+                        x[i], y[i], state[i]);
+                }
+            }
+
+        private:
+            double _saccadeDistance;
+            int _historyLength;
+
+            // historyLength + 1 runs per axis, the x and y runs of each stream together
+            std::vector<double> _values;
+            std::vector<int> _counts;
+            std::vector<double> _scratch;
+            std::vector<Kernels::StampeHistory> _historyX;
+            std::vector<Kernels::StampeHistory> _historyY;
+            std::vector<FIXATION> _fixation;
+        };
+
+        class OneEuroFilterBank : public FilterBank
+        {
+        public:
+            OneEuroFilterBank(const FILTER_PARAMETERS& parameters, int streams)
+                : FilterBank(streams),
+                  _beta(parameters.beta),
+                  _cutoff(parameters.cutoff),
+                  _timestamps(streams),
+                  _lastTimestamp(streams),
+                  _pointX(streams),
+                  _pointY(streams),
+                  _velocityX(streams),
+                  _velocityY(streams),
+                  _fixation(streams)
+            {
+                reset();
+            }
+
+            void reset() override
+            {
+                std::fill(_lastTimestamp.begin(), _lastTimestamp.end(), 0.0);
+                std::fill(_pointX.begin(), _pointX.end(), 0.0);
+                std::fill(_pointY.begin(), _pointY.end(), 0.0);
+                std::fill(_velocityX.begin(), _velocityX.end(), 0.0);
+                std::fill(_velocityY.begin(), _velocityY.end(), 0.0);
+            }
+
+            void update(const long long* timestamps, double* x, double* y, FIXATION* fixation) override
+            {
+                // 64 bit integer to double conversion has no SIMD form before AVX-512,
+                // so convert up front and keep it out of the filter loop
+                for (int i = 0; i < _streams; i++)
+                {
+                    _timestamps[i] = static_cast<double>(timestamps[i]);
+                }
+
+                oneEuroStreams(_streams, _beta, _cutoff, _timestamps.data(), x, y, _lastTimestamp.data(),
+                    _pointX.data(), _pointY.data(), _velocityX.data(), _velocityY.data(),
+                    fixation != nullptr ? fixation : _fixation.data());
+            }
+
+        private:
+            double _beta;
+            double _cutoff;
+            std::vector<double> _timestamps;
+            std::vector<double> _lastTimestamp;
+            std::vector<double> _pointX;
+            std::vector<double> _pointY;
+            std::vector<double> _velocityX;
+            std::vector<double> _velocityY;
+            std::vector<FIXATION> _fixation;
+        };
+
+        class SimpleKalmanFilterBank : public FilterBank
+        {
+        public:
+            explicit SimpleKalmanFilterBank(int streams)
+                : FilterBank(streams),
+                  _estimateCovarianceX(streams),
+                  _estimateCovarianceY(streams),
+                  _filteredX(streams),
+                  _filteredY(streams)
+            {
+                reset();
+            }
+
+            void reset() override
+            {
+                std::fill(_estimateCovarianceX.begin(), _estimateCovarianceX.end(), Kernels::KalmanInitialEstimateCovariance);
+                std::fill(_estimateCovarianceY.begin(), _estimateCovarianceY.end(), Kernels::KalmanInitialEstimateCovariance);
+                std::fill(_filteredX.begin(), _filteredX.end(), 0.0);
+                std::fill(_filteredY.begin(), _filteredY.end(), 0.0);
+            }
+
+            void update(const long long* /*timestamps*/, double* x, double* y, FIXATION* /*fixation*/) override
+            {
+                kalmanStreams(_streams, x, y, _filteredX.data(), _filteredY.data(),
+                    _estimateCovarianceX.data(), _estimateCovarianceY.data());
+            }
+
+        private:
+            std::vector<double> _estimateCovarianceX;
+            std::vector<double> _estimateCovarianceY;
+            std::vector<double> _filteredX;
+            std::vector<double> _filteredY;
+        };
+
+        class AveragingFilterBank : public FilterBank
+        {
+        public:
+            AveragingFilterBank(const FILTER_PARAMETERS& parameters, int streams)
+                : FilterBank(streams),
+                  _averageCount(parameters.averageCount),
+                  _valuesX(static_cast<size_t>(streams) * parameters.averageCount),
+                  _valuesY(static_cast<size_t>(streams) * parameters.averageCount),
+                  _sumX(streams),
+                  _sumY(streams)
+            {
+                reset();
+            }
+
+            void reset() override
+            {
+                std::fill(_valuesX.begin(), _valuesX.end(), 0.0);
+                std::fill(_valuesY.begin(), _valuesY.end(), 0.0);
+                std::fill(_sumX.begin(), _sumX.end(), 0.0);
+                std::fill(_sumY.begin(), _sumY.end(), 0.0);
+                _next = 0;
+                _count = 0;
+            }
+
+            void update(const long long* /*timestamps*/, double* x, double* y, FIXATION* /*fixation*/) override
+            {
+                bool full = _count == _averageCount;
+                if (!full)
+                {
+                    _count++;
+                }
+
+                size_t row = static_cast<size_t>(_next) * _streams;
+                averageStreams(_streams, full, _count, x, y, _valuesX.data() + row, _valuesY.data() + row,
+                    _sumX.data(), _sumY.data());
+                _next = _next + 1 == _averageCount ? 0 : _next + 1;
+            }
+
+        private:
+            int _averageCount;
+
+            // averageCount rows of one value per stream; every stream shares the ring position
+            std::vector<double> _valuesX;
+            std::vector<double> _valuesY;
+            std::vector<double> _sumX;
+            std::vector<double> _sumY;
+            int _next;
+            int _count;
+        };
+    }
+
+    std::unique_ptr<FilterBank> createFilterBank(FILTER_TYPE type, const FILTER_PARAMETERS& parameters, int streams)
+    {
+        if (streams <= 0 || !validParameters(type, parameters))
+        {
+            return nullptr;
+        }
+
+        switch (type)
+        {
+        case FILTER_TYPE::GAIN_FILTER:
+            return std::unique_ptr<FilterBank>(new GainFilterBank(parameters, streams));
+        case FILTER_TYPE::STAMPE_FILTER:
+            return std::unique_ptr<FilterBank>(new StampeFilterBank(parameters, streams));
+        case FILTER_TYPE::ONE_EURO_FILTER:
+            return std::unique_ptr<FilterBank>(new OneEuroFilterBank(parameters, streams));
+        case FILTER_TYPE::NULL_FILTER:
+            return std::unique_ptr<FilterBank>(new NullFilterBank(streams));
+        case FILTER_TYPE::SIMPLE_KALMAN_FILTER:
+            return std::unique_ptr<FilterBank>(new SimpleKalmanFilterBank(streams));
+        case FILTER_TYPE::AVERAGING_FILTER:
+            return std::unique_ptr<FilterBank>(new AveragingFilterBank(parameters, streams));
+        }
+        return nullptr;
+    }
+}
@@ -0,0 +1,195 @@
+#include "GazeFilters.h"
+#include "Kernels.h"
+
+#include <algorithm>
+
+namespace GazeFilters
+{
+    FILTER_PARAMETERS defaultParameters()
+    {
+        FILTER_PARAMETERS parameters;
+        parameters.saccadeDistance = 0.07;
+        parameters.gain = 0.04;
+        parameters.historyLength = 15;
+        parameters.beta = 5;
+        parameters.cutoff = 0.1;
+        parameters.averageCount = 10;
+        return parameters;
+    }
+
+    bool validParameters(FILTER_TYPE type, const FILTER_PARAMETERS& parameters)
+    {
+        switch (type)
+        {
+        case FILTER_TYPE::STAMPE_FILTER:
+            return parameters.historyLength >= 0;
+        case FILTER_TYPE::AVERAGING_FILTER:
+            return parameters.averageCount > 0;
+        case FILTER_TYPE::GAIN_FILTER:
+        case FILTER_TYPE::ONE_EURO_FILTER:
+        case FILTER_TYPE::NULL_FILTER:
+        case FILTER_TYPE::SIMPLE_KALMAN_FILTER:
+            return true;
+        }
+        return false;
+    }
+
+    std::unique_ptr<Filter> createFilter(FILTER_TYPE type, const FILTER_PARAMETERS& parameters)
+    {
+        if (!validParameters(type, parameters))
+        {
+            return nullptr;
+        }
+
+        switch (type)
+        {
+        case FILTER_TYPE::GAIN_FILTER:
+            return std::unique_ptr<Filter>(new GainFilter(parameters));
+        case FILTER_TYPE::STAMPE_FILTER:
+            return std::unique_ptr<Filter>(new StampeFilter(parameters));
+        case FILTER_TYPE::ONE_EURO_FILTER:
+            return std::unique_ptr<Filter>(new OneEuroFilter(parameters));
+        case FILTER_TYPE::NULL_FILTER:
+            return std::unique_ptr<Filter>(new NullFilter());
+        case FILTER_TYPE::SIMPLE_KALMAN_FILTER:
+            return std::unique_ptr<Filter>(new SimpleKalmanFilter());
+        case FILTER_TYPE::AVERAGING_FILTER:
+            return std::unique_ptr<Filter>(new AveragingFilter(parameters));
+        }
+        return nullptr;
+    }
+
+    void NullFilter::process(GAZE_SAMPLE* /*samples*/, size_t /*count*/)
+    {
+    }
+
+    GainFilter::GainFilter(const FILTER_PARAMETERS& parameters)
+        : _saccadeDistance(parameters.saccadeDistance),
+          _gain(parameters.gain)
+    {
+        reset();
+    }
+
+    void GainFilter::reset()
+    {
+        _filteredX = 0;
+        _filteredY = 0;
+    }
+
+    void GainFilter::process(GAZE_SAMPLE* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            GAZE_SAMPLE& sample = samples[i];
+            Kernels::gain(_saccadeDistance, _gain, sample.x, sample.y, _filteredX, _filteredY, sample.fixation);
+        }
+    }
+
+    StampeFilter::StampeFilter(const FILTER_PARAMETERS& parameters)
+        : _saccadeDistance(parameters.saccadeDistance),
+          _historyLength(parameters.historyLength),
+          _values(2 * static_cast<size_t>(parameters.historyLength + 1)),
+          _counts(2 * static_cast<size_t>(parameters.historyLength + 1)),
+          _scratch(parameters.historyLength + 1)
+    {
+        _historyX.values = _values.data();
+        _historyX.counts = _counts.data();
+        _historyY.values = _values.data() + _historyLength + 1;
+        _historyY.counts = _counts.data() + _historyLength + 1;
+        reset();
+    }
+
+    void StampeFilter::reset()
+    {
+        Kernels::resetStampeHistory(_historyX, _historyLength);
+        Kernels::resetStampeHistory(_historyY, _historyLength);
+    }
+
+    void StampeFilter::process(GAZE_SAMPLE* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            GAZE_SAMPLE& sample = samples[i];
+            Kernels::stampe(_saccadeDistance, _historyLength, _historyX, _historyY, _scratch.data(),
+                sample.x, sample.y, sample.fixation);
+        }
+    }
+
+    OneEuroFilter::OneEuroFilter(const FILTER_PARAMETERS& parameters)
+        : _beta(parameters.beta),
+          _cutoff(parameters.cutoff)
+    {
+        reset();
+    }
+
+    void OneEuroFilter::reset()
+    {
+        _lastTimestamp = 0;
+        _pointX = _pointY = 0;
+        _velocityX = _velocityY = 0;
+    }
+
+    void OneEuroFilter::process(GAZE_SAMPLE* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            GAZE_SAMPLE& sample = samples[i];
+            Kernels::oneEuro(_beta, _cutoff, static_cast<double>(sample.timestamp), sample.x, sample.y,
+                _lastTimestamp, _pointX, _pointY, _velocityX, _velocityY, sample.fixation);
+        }
+    }
+
+    SimpleKalmanFilter::SimpleKalmanFilter()
+    {
+        reset();
+    }
+
+    void SimpleKalmanFilter::reset()
+    {
+        _estimateCovarianceX = _estimateCovarianceY = Kernels::KalmanInitialEstimateCovariance;
+        _filteredX = _filteredY = 0;
+    }
+
+    void SimpleKalmanFilter::process(GAZE_SAMPLE* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            GAZE_SAMPLE& sample = samples[i];
+            Kernels::kalman(sample.x, sample.y, _filteredX, _filteredY, _estimateCovarianceX, _estimateCovarianceY);
+        }
+    }
+
+    AveragingFilter::AveragingFilter(const FILTER_PARAMETERS& parameters)
+        : _averageCount(parameters.averageCount),
+          _valuesX(parameters.averageCount),
+          _valuesY(parameters.averageCount)
+    {
+        reset();
+    }
+
+    void AveragingFilter::reset()
+    {
+        std::fill(_valuesX.begin(), _valuesX.end(), 0.0);
+        std::fill(_valuesY.begin(), _valuesY.end(), 0.0);
+        _next = 0;
+        _count = 0;
+        _sumX = _sumY = 0;
+    }
+
+    void AveragingFilter::process(GAZE_SAMPLE* samples, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            GAZE_SAMPLE& sample = samples[i];
+            bool full = _count == _averageCount;
+            if (!full)
+            {
+                _count++;
+            }
+
+            // once the ring is full the next slot holds the oldest value
+            Kernels::average(sample.x, sample.y, _valuesX[_next], _valuesY[_next], _sumX, _sumY, full, _count);
+            _next = _next + 1 == _averageCount ? 0 : _next + 1;
+        }
+    }
+}
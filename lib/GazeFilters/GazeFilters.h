@@ -0,0 +1,150 @@
+#ifndef GAZEFILTERS_GAZEFILTERS_H
+#define GAZEFILTERS_GAZEFILTERS_H
+
+#include "GazeFiltersAPI.h"
+#include "Kernels.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace GazeFilters
+{
+    FILTER_PARAMETERS defaultParameters();
+
+    /** \brief False if the parameters cannot be used to create the filter.
+    */
+    bool validParameters(FILTER_TYPE type, const FILTER_PARAMETERS& parameters);
+
+    /** \brief Filter for a single stream. Each filter reproduces its Microsoft.HandsFree.Filters
+    counterpart sample for sample, but works in place over state allocated up front.
+    */
+    class Filter
+    {
+    public:
+        virtual ~Filter() = default;
+
+        virtual void reset() = 0;
+
+        /** \brief Filter consecutive samples in place, oldest first.
+        */
+        virtual void process(GAZE_SAMPLE* samples, size_t count) = 0;
+    };
+
+    std::unique_ptr<Filter> createFilter(FILTER_TYPE type, const FILTER_PARAMETERS& parameters);
+
+    class NullFilter : public Filter
+    {
+    public:
+        void reset() override {}
+        void process(GAZE_SAMPLE* samples, size_t count) override;
+    };
+
+    class GainFilter : public Filter
+    {
+    public:
+        explicit GainFilter(const FILTER_PARAMETERS& parameters);
+
+        void reset() override;
+        void process(GAZE_SAMPLE* samples, size_t count) override;
+
+    private:
+        double _saccadeDistance;
+        double _gain;
+        double _filteredX;
+        double _filteredY;
+    };
+
+    class StampeFilter : public Filter
+    {
+    public:
+        explicit StampeFilter(const FILTER_PARAMETERS& parameters);
+
+        void reset() override;
+        void process(GAZE_SAMPLE* samples, size_t count) override;
+
+    private:
+        double _saccadeDistance;
+        int _historyLength;
+
+        // historyLength + 1 runs per axis, and room to write the history out in full
+        std::vector<double> _values;
+        std::vector<int> _counts;
+        std::vector<double> _scratch;
+        Kernels::StampeHistory _historyX;
+        Kernels::StampeHistory _historyY;
+    };
+
+    class OneEuroFilter : public Filter
+    {
+    public:
+        explicit OneEuroFilter(const FILTER_PARAMETERS& parameters);
+
+        void reset() override;
+        void process(GAZE_SAMPLE* samples, size_t count) override;
+
+    private:
+        double _beta;
+        double _cutoff;
+        double _lastTimestamp;
+        double _pointX, _pointY;
+        double _velocityX, _velocityY;
+    };
+
+    class SimpleKalmanFilter : public Filter
+    {
+    public:
+        SimpleKalmanFilter();
+
+        void reset() override;
+        void process(GAZE_SAMPLE* samples, size_t count) override;
+
+    private:
+        double _estimateCovarianceX, _estimateCovarianceY;
+        double _filteredX, _filteredY;
+    };
+
+    class AveragingFilter : public Filter
+    {
+    public:
+        explicit AveragingFilter(const FILTER_PARAMETERS& parameters);
+
+        void reset() override;
+        void process(GAZE_SAMPLE* samples, size_t count) override;
+
+    private:
+        int _averageCount;
+        std::vector<double> _valuesX;
+        std::vector<double> _valuesY;
+        int _next;
+        int _count;
+        double _sumX, _sumY;
+    };
+
+    /** \brief The same filter over many independent streams. The state of each filter is stored
+    one array per field with one element per stream, and update() runs each field across all
+    the streams in a single loop, so the compiler can vectorize it.
+    */
+    class FilterBank
+    {
+    public:
+        virtual ~FilterBank() = default;
+
+        int streams() const { return _streams; }
+
+        virtual void reset() = 0;
+
+        /** \brief Filter the next sample of every stream in place. fixation may be null.
+        */
+        virtual void update(const long long* timestamps, double* x, double* y, FIXATION* fixation) = 0;
+
+    protected:
+        explicit FilterBank(int streams) : _streams(streams) {}
+
+        int _streams;
+    };
+
+    std::unique_ptr<FilterBank> createFilterBank(FILTER_TYPE type, const FILTER_PARAMETERS& parameters, int streams);
+}
+
+#endif //GAZEFILTERS_GAZEFILTERS_H
@@ -0,0 +1,78 @@
+//
+// C interface over GazeFilters.h. Handles are the C++ filter objects.
+//
+
+#include "GazeFilters.h"
+
+namespace
+{
+    GazeFilters::FILTER_PARAMETERS parametersOrDefault(const GazeFilters::FILTER_PARAMETERS* parameters)
+    {
+        return parameters != nullptr ? *parameters : GazeFilters::defaultParameters();
+    }
+}
+
+extern "C" {
+    namespace GazeFilters
+    {
+        GAZEFILTERS_API void getDefaultFilterParameters(FILTER_PARAMETERS* parameters)
+        {
+            if (parameters != nullptr)
+            {
+                *parameters = defaultParameters();
+            }
+        }
+
+        GAZEFILTERS_API FILTER_HANDLE createFilter(FILTER_TYPE type, const FILTER_PARAMETERS* parameters)
+        {
+            return GazeFilters::createFilter(type, parametersOrDefault(parameters)).release();
+        }
+
+        GAZEFILTERS_API void destroyFilter(FILTER_HANDLE filter)
+        {
+            delete static_cast<Filter*>(filter);
+        }
+
+        GAZEFILTERS_API void resetFilter(FILTER_HANDLE filter)
+        {
+            if (filter != nullptr)
+            {
+                static_cast<Filter*>(filter)->reset();
+            }
+        }
+
+        GAZEFILTERS_API void filterSamples(FILTER_HANDLE filter, GAZE_SAMPLE* samples, int count)
+        {
+            if (filter != nullptr && samples != nullptr && count > 0)
+            {
+                static_cast<Filter*>(filter)->process(samples, static_cast<size_t>(count));
+            }
+        }
+
+        GAZEFILTERS_API FILTER_BANK_HANDLE createFilterBank(FILTER_TYPE type, const FILTER_PARAMETERS* parameters, int streams)
+        {
+            return GazeFilters::createFilterBank(type, parametersOrDefault(parameters), streams).release();
+        }
+
+        GAZEFILTERS_API void destroyFilterBank(FILTER_BANK_HANDLE bank)
+        {
+            delete static_cast<FilterBank*>(bank);
+        }
+
+        GAZEFILTERS_API void resetFilterBank(FILTER_BANK_HANDLE bank)
+        {
+            if (bank != nullptr)
+            {
+                static_cast<FilterBank*>(bank)->reset();
+            }
+        }
+
+        GAZEFILTERS_API void filterBankUpdate(FILTER_BANK_HANDLE bank, const long long* timestamps, double* x, double* y, FIXATION* fixation)
+        {
+            if (bank != nullptr && timestamps != nullptr && x != nullptr && y != nullptr)
+            {
+                static_cast<FilterBank*>(bank)->update(timestamps, x, y, fixation);
+            }
+        }
+    }
+}
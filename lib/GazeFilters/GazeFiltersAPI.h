@@ -0,0 +1,134 @@
+/*! \GazeFiltersAPI
+ *
+ * Native implementation of the gaze smoothing filters in Microsoft.HandsFree.Filters.
+ * Samples are filtered in place and the filters never allocate after they are created,
+ * so hours of recorded gaze data can be run through them in seconds.
+ *
+ * A filter processes a batch of samples from one stream. A filter bank runs the same
+ * filter over many independent streams at once, one sample per stream per update,
+ * with the per-stream state laid out so the update vectorizes across streams. The Stampe
+ * filter's update depends on the data, so its bank steps the streams one at a time and is
+ * no faster than filtering each stream as a batch.
+ */
+
+#ifndef GAZEFILTERSAPI_H
+#define GAZEFILTERSAPI_H
+
+#ifdef WIN32
+    #ifdef GazeFilters_STATIC
+        #define GAZEFILTERS_API
+    #elif defined GazeFilters_EXPORTS
+        #define GAZEFILTERS_API __declspec(dllexport)
+    #else
+        #define GAZEFILTERS_API __declspec(dllimport)
+    #endif
+#else
+    #define GAZEFILTERS_API __attribute__((visibility("default")))
+#endif
+
+namespace GazeFilters
+{
+    /** \brief The filters, in the same order as Microsoft.HandsFree.Filters.FilterType
+    */
+    enum class FILTER_TYPE
+    {
+        GAIN_FILTER,            ///< Exponential smoothing that snaps to the new point on a saccade.
+        STAMPE_FILTER,          ///< Stampe's heuristic filter, generalized to any history length.
+        ONE_EURO_FILTER,        ///< Speed-adaptive low pass filter (Casiez et al., CHI 2012).
+        NULL_FILTER,            ///< Passes samples through unchanged.
+        SIMPLE_KALMAN_FILTER,   ///< Scalar Kalman filter per axis.
+        AVERAGING_FILTER        ///< Moving average over the last samples.
+    };
+
+    /** \brief Fixation state reported with each filtered sample, as in Microsoft.HandsFree.Sensors.Fixation
+    */
+    enum class FIXATION
+    {
+        UNKNOWN,
+        FIXATED,
+        NOT_FIXATED
+    };
+
+    /** \brief Filter parameters. The defaults match Microsoft.HandsFree.Filters.Settings.
+    */
+    struct FILTER_PARAMETERS
+    {
+        double saccadeDistance;     ///< Gain and Stampe filters: distance treated as a saccade, in screen fractions. Default 0.07.
+        double gain;                ///< Gain filter: smoothing gain. Default 0.04.
+        int historyLength;          ///< Stampe filter: history length in samples. Default 15.
+        double beta;                ///< One Euro filter: speed coefficient. Default 5.
+        double cutoff;              ///< One Euro filter: minimum cutoff frequency in Hz. Default 0.1.
+        int averageCount;           ///< Averaging filter: number of samples averaged. Default 10.
+    };
+
+    /** \brief One gaze sample. x and y are normalized to the screen, the timestamp is in milliseconds.
+    */
+    struct GAZE_SAMPLE
+    {
+        long long timestamp;
+        double x;
+        double y;
+        FIXATION fixation;
+    };
+
+    typedef void* FILTER_HANDLE;
+    typedef void* FILTER_BANK_HANDLE;
+}
+
+extern "C" {
+    namespace GazeFilters
+    {
+        /** \brief Fill in the default filter parameters.
+        */
+        GAZEFILTERS_API void getDefaultFilterParameters(FILTER_PARAMETERS* parameters);
+
+        /** \brief Create a filter for a single stream of samples.
+        \param[in] type         The filter to create.
+        \param[in] parameters   The filter parameters, or null for the defaults.
+        \return The filter, or null if the type or parameters are invalid.
+        */
+        GAZEFILTERS_API FILTER_HANDLE createFilter(FILTER_TYPE type, const FILTER_PARAMETERS* parameters);
+
+        /** \brief Destroy a filter created by createFilter().
+        */
+        GAZEFILTERS_API void destroyFilter(FILTER_HANDLE filter);
+
+        /** \brief Return a filter to the state it was created in.
+        */
+        GAZEFILTERS_API void resetFilter(FILTER_HANDLE filter);
+
+        /** \brief Filter a batch of consecutive samples in place.
+        \param[in] filter       The filter.
+        \param[in,out] samples  The samples, oldest first. The filtered point and fixation state replace the input.
+        \param[in] count        The number of samples.
+        */
+        GAZEFILTERS_API void filterSamples(FILTER_HANDLE filter, GAZE_SAMPLE* samples, int count);
+
+        /** \brief Create a bank of filters that run over many independent streams.
+        \param[in] type         The filter used for every stream.
+        \param[in] parameters   The filter parameters, or null for the defaults.
+        \param[in] streams      The number of streams.
+        \return The filter bank, or null if the type or parameters are invalid.
+        */
+        GAZEFILTERS_API FILTER_BANK_HANDLE createFilterBank(FILTER_TYPE type, const FILTER_PARAMETERS* parameters, int streams);
+
+        /** \brief Destroy a filter bank created by createFilterBank().
+        */
+        GAZEFILTERS_API void destroyFilterBank(FILTER_BANK_HANDLE bank);
+
+        /** \brief Return every stream of a filter bank to the state it was created in.
+        */
+        GAZEFILTERS_API void resetFilterBank(FILTER_BANK_HANDLE bank);
+
+        /** \brief Filter the next sample of every stream in place.
+        \param[in] bank         The filter bank.
+        \param[in] timestamps   One timestamp per stream, in milliseconds.
+        \param[in,out] x        One x coordinate per stream, replaced by the filtered value.
+        \param[in,out] y        One y coordinate per stream, replaced by the filtered value.
+        \param[in,out] fixation One fixation state per stream, replaced by the filter's. May be null.
+        */
+        GAZEFILTERS_API void filterBankUpdate(FILTER_BANK_HANDLE bank, const long long* timestamps, double* x, double* y, FIXATION* fixation);
+    }
+}
+
+#endif //GAZEFILTERSAPI_H
@@ -0,0 +1,369 @@
+#ifndef GAZEFILTERS_KERNELS_H
+#define GAZEFILTERS_KERNELS_H
+
+#include "GazeFiltersAPI.h"
+
+#include <cmath>
+
+//
+// Per-sample update for each filter. The single stream filters and the filter banks share
+// these, so both produce the same output as the managed filters. Conditions are written as
+// selects rather than branches, and each reads its state once and writes it once, so that the
+// filter bank loops vectorize.
+//
+
+namespace GazeFilters
+{
+    namespace Kernels
+    {
+        const double Pi = 3.14159265358979323846;
+
+        // One Euro filter: cutoff frequency of the velocity filter
+        const double VelocityCutoff = 1;
+
+        // Kalman filter: measurement noise and starting estimate covariance, as in SimpleKalmanFilter.cs
+        const double KalmanMeasurementCovariance = 0.03;
+        const double KalmanInitialEstimateCovariance = 1;
+
+        inline bool isValid(double value)
+        {
+            return value == value;
+        }
+
+        inline void gain(double saccadeDistance, double gain,
+            double& x, double& y, double& filteredX, double& filteredY, FIXATION& fixation)
+        {
+            double measuredX = x;
+            double measuredY = y;
+            double lastX = filteredX;
+            double lastY = filteredY;
+            bool valid = isValid(measuredX) & isValid(measuredY);
+
+            double dx = lastX - measuredX;
+            double dy = lastY - measuredY;
+            bool saccade = std::sqrt((dx * dx) + (dy * dy)) > saccadeDistance;
+
+            double newX = saccade ? measuredX : lastX + (gain * (measuredX - lastX));
+            double newY = saccade ? measuredY : lastY + (gain * (measuredY - lastY));
+            FIXATION newFixation = saccade ? FIXATION::NOT_FIXATED : FIXATION::FIXATED;
+
+            // A missing sample repeats the last filtered point and keeps its fixation state
+            newX = valid ? newX : lastX;
+            newY = valid ? newY : lastY;
+            fixation = valid ? newFixation : fixation;
+
+            filteredX = newX;
+            filteredY = newY;
+            x = newX;
+            y = newY;
+        }
+
+        inline double alpha(double rate, double cutoff)
+        {
+            double te = 1.0 / rate;
+            double tau = 1.0 / (2 * Pi * cutoff);
+            return te / (te + tau);
+        }
+
+        /** \brief One Euro filter update. The timestamps are in milliseconds; they are held as doubles,
+        which is exact for any timestamp below 2^53.
+        The first sample initializes the filter and passes through unchanged; after that the fixation
+        state is unknown.
+        */
+        inline void oneEuro(double beta, double cutoff, double timestamp,
+            double& x, double& y, double& lastTimestamp,
+            double& pointX, double& pointY, double& velocityX, double& velocityY, FIXATION& fixation)
+        {
+            double measuredX = x;
+            double measuredY = y;
+            double lastX = pointX;
+            double lastY = pointY;
+            double last = lastTimestamp;
+            bool first = last == 0;
+
+            // determine sampling frequency based on last time stamp
+            double rate = 1000.0 / (timestamp - last);
+
+            // filter the velocity; its magnitude raises the cutoff used for the point
+            double velocityAlpha = alpha(rate, VelocityCutoff);
+            double newVelocityX = (velocityAlpha * ((measuredX - lastX) * rate)) + ((1 - velocityAlpha) * velocityX);
+            double newVelocityY = (velocityAlpha * ((measuredY - lastY) * rate)) + ((1 - velocityAlpha) * velocityY);
+
+            double alphaX = alpha(rate, cutoff + (beta * std::fabs(newVelocityX)));
+            double alphaY = alpha(rate, cutoff + (beta * std::fabs(newVelocityY)));
+            double newX = (alphaX * measuredX) + ((1 - alphaX) * lastX);
+            double newY = (alphaY * measuredY) + ((1 - alphaY) * lastY);
+
+            newVelocityX = first ? 0.0 : newVelocityX;
+            newVelocityY = first ? 0.0 : newVelocityY;
+            newX = first ? measuredX : newX;
+            newY = first ? measuredY : newY;
+            fixation = first ? fixation : FIXATION::UNKNOWN;
+
+            lastTimestamp = timestamp;
+            velocityX = newVelocityX;
+            velocityY = newVelocityY;
+            pointX = newX;
+            pointY = newY;
+            x = newX;
+            y = newY;
+        }
+
+        inline void kalman(double& x, double& y, double& filteredX, double& filteredY,
+            double& estimateCovarianceX, double& estimateCovarianceY)
+        {
+            double measuredX = x;
+            double measuredY = y;
+            double lastX = filteredX;
+            double lastY = filteredY;
+            double covarianceX = estimateCovarianceX;
+            double covarianceY = estimateCovarianceY;
+            bool valid = isValid(measuredX) & isValid(measuredY);
+
+            double gainX = covarianceX / (covarianceX + KalmanMeasurementCovariance);
+            double gainY = covarianceY / (covarianceY + KalmanMeasurementCovariance);
+            double newX = lastX + (gainX * (measuredX - lastX));
+            double newY = lastY + (gainY * (measuredY - lastY));
+            double newCovarianceX = (1 - gainX) * covarianceX;
+            double newCovarianceY = (1 - gainY) * covarianceY;
+
+            newX = valid ? newX : lastX;
+            newY = valid ? newY : lastY;
+            estimateCovarianceX = valid ? newCovarianceX : covarianceX;
+            estimateCovarianceY = valid ? newCovarianceY : covarianceY;
+
+            filteredX = newX;
+            filteredY = newY;
+            x = newX;
+            y = newY;
+        }
+
+        /** \brief Moving average over a ring of averageCount values per axis.
+        next and count track the ring; they are advanced by the caller.
+        */
+        inline void average(double& x, double& y, double& oldestX, double& oldestY, double& sumX, double& sumY,
+            bool full, int count)
+        {
+            // add first and subtract second, in the same order as AveragingFilter.cs
+            sumX = (sumX + x) - (full ? oldestX : 0.0);
+            sumY = (sumY + y) - (full ? oldestY : 0.0);
+            oldestX = x;
+            oldestY = y;
+            x = sumX / count;
+            y = sumY / count;
+        }
+
+        /** \brief One axis of the Stampe filter history: the last historyLength values, newest first,
+        kept as runs of equal values in a ring of historyLength + 1 runs. The values up to the first NaN
+        are always monotone, and the managed filter only ever changes the newest runs of them, so an
+        update costs O(1) amortized instead of a shift and a scan of the whole history.
+        */
+        struct StampeHistory
+        {
+            double* values;     ///< Value of each run.
+            int* counts;        ///< Number of samples in each run.
+            int head;           ///< Newest run.
+            int runs;
+            int invalid;        ///< NaN samples in the history.
+            bool ordered;       ///< The values up to the first NaN are monotone, so the incremental update applies.
+        };
+
+        inline void resetStampeHistory(StampeHistory& history, int historyLength)
+        {
+            history.values[0] = 0;
+            history.counts[0] = historyLength;
+            history.head = 0;
+            history.runs = historyLength > 0 ? 1 : 0;
+            history.invalid = 0;
+            history.ordered = true;
+        }
+
+        /** \brief The update exactly as the managed filter does it, from position first on, over the
+        history written out to scratch, which has room for historyLength + 1 values. The runs are rebuilt
+        from the result.
+        */
+        inline double stampeAxisScan(StampeHistory& history, int historyLength, double* scratch, double value, int first)
+        {
+            const int capacity = historyLength + 1;
+
+            // the newest sample is inserted at the beginning
+            scratch[0] = value;
+            for (int run = 0, slot = history.head, n = 1; run < history.runs; run++)
+            {
+                for (int k = 0; k < history.counts[slot]; k++)
+                {
+                    scratch[n++] = history.values[slot];
+                }
+                slot = slot + 1 == capacity ? 0 : slot + 1;
+            }
+
+            for (int i = first; i < historyLength; i++)
+            {
+                //
+                // This block ensures that the entire history we are maintaining
+                // is either steadily increasing, or steadily decreasing or all equal
+                //
+                double current = scratch[i];
+                double previous = scratch[i + 1];
+                if (scratch[1] == current)
+                {
+                    if (((current < previous) && (current < value)) ||
+                        ((current > previous) && (current > value)))
+                    {
+                        double replacement = std::fabs(current - previous) < std::fabs(current - value) ? previous : value;
+                        for (int j = 1; j <= i; j++)
+                        {
+                            scratch[j] = replacement;
+                        }
+                    }
+                }
+            }
+
+            // the oldest value drops out and the rest become the runs again
+            history.head = 0;
+            history.runs = 0;
+            history.invalid = 0;
+            history.ordered = true;
+            int direction = 0;
+            for (int n = 0; n < historyLength; n++)
+            {
+                double current = scratch[n];
+                int last = history.runs - 1;
+                if (last >= 0 && history.values[last] == current)
+                {
+                    history.counts[last]++;
+                    continue;
+                }
+
+                if (!isValid(current))
+                {
+                    history.invalid++;
+                    direction = 2;
+                }
+                else if (last >= 0 && direction != 2)
+                {
+                    int step = current > history.values[last] ? 1 : -1;
+                    history.ordered = history.ordered && (direction == 0 || direction == step);
+                    direction = step;
+                }
+                history.values[history.runs] = current;
+                history.counts[history.runs] = 1;
+                history.runs++;
+            }
+
+            return scratch[historyLength];
+        }
+
+        /** \brief One axis of the Stampe filter.
+        \return The oldest value, which is the filter output.
+        */
+        inline double stampeAxis(StampeHistory& history, int historyLength, double* scratch, double value)
+        {
+            if (historyLength == 0)
+            {
+                return value;
+            }
+            if (!history.ordered)
+            {
+                return stampeAxisScan(history, historyLength, scratch, value, 1);
+            }
+
+            const int capacity = historyLength + 1;
+            double* values = history.values;
+            int* counts = history.counts;
+
+            // The managed filter looks for runs at the start of the history that are a peak or a trough
+            // between the newest sample and the value before them, and flattens each one onto whichever
+            // of the two is closer. In a monotone history only the newest run can be one, and once it is
+            // flattened onto the run after it the combined run is the next one to look at. A NaN stops
+            // this, since every comparison with it is false.
+            while (history.runs >= 2)
+            {
+                int next = history.head + 1 == capacity ? 0 : history.head + 1;
+                double current = values[history.head];
+                double previous = values[next];
+                if (!(((current < previous) && (current < value)) ||
+                      ((current > previous) && (current > value))))
+                {
+                    break;
+                }
+
+                if (std::fabs(current - previous) < std::fabs(current - value))
+                {
+                    counts[next] += counts[history.head];
+                    history.head = next;
+                    history.runs--;
+                    continue;
+                }
+
+                values[history.head] = value;
+                if (previous == value)
+                {
+                    counts[next] += counts[history.head];
+                    history.head = next;
+                    history.runs--;
+                }
+                break;
+            }
+
+            // Past a NaN the managed filter only acts where a value equals the newest one. That takes
+            // two identical samples on either side of a lost one, so it is looked for here and the
+            // rest of the update is left to the scan when it happens.
+            if (history.invalid > 0 && isValid(values[history.head]))
+            {
+                int firstInvalid = 0;
+                for (int run = 0, slot = history.head, position = 1; run < history.runs && position < historyLength; run++)
+                {
+                    if (firstInvalid != 0 && values[slot] == values[history.head])
+                    {
+                        return stampeAxisScan(history, historyLength, scratch, value, firstInvalid);
+                    }
+                    firstInvalid = firstInvalid == 0 && !isValid(values[slot]) ? position : firstInvalid;
+                    position += counts[slot];
+                    slot = slot + 1 == capacity ? 0 : slot + 1;
+                }
+            }
+
+            // the oldest value drops out
+            int oldest = history.head + history.runs - 1;
+            oldest = oldest >= capacity ? oldest - capacity : oldest;
+            double output = values[oldest];
+            if (--counts[oldest] == 0)
+            {
+                history.runs--;
+                history.invalid -= isValid(output) ? 0 : 1;
+            }
+
+            // the newest sample is inserted at the beginning
+            if (history.runs > 0 && values[history.head] == value)
+            {
+                counts[history.head]++;
+            }
+            else
+            {
+                history.head = history.head == 0 ? capacity - 1 : history.head - 1;
+                values[history.head] = value;
+                counts[history.head] = 1;
+                history.runs++;
+                history.invalid += isValid(value) ? 0 : 1;
+            }
+
+            return output;
+        }
+
+        inline void stampe(double saccadeDistance, int historyLength, StampeHistory& historyX, StampeHistory& historyY,
+            double* scratch, double& x, double& y, FIXATION& fixation)
+        {
+            double newestX = x;
+            double newestY = y;
+            x = stampeAxis(historyX, historyLength, scratch, newestX);
+            y = stampeAxis(historyY, historyLength, scratch, newestY);
+
+            fixation = (std::fabs(newestX - x) < saccadeDistance) && (std::fabs(newestY - y) < saccadeDistance)
+                ? FIXATION::FIXATED
+                : FIXATION::NOT_FIXATED;
+        }
+    }
+}
+
+#endif //GAZEFILTERS_KERNELS_H
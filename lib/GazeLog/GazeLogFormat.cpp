@@ -0,0 +1,36 @@
+#include "GazeLogFormat.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace GazeLog
+{
+    namespace
+    {
+        // 100 ns intervals between 1601-01-01, the Windows file time epoch, and 1970-01-01
+        const int64_t FileTimeUnixEpoch = 116444736000000000LL;
+    }
+
+    GazeLogHeader makeHeader()
+    {
+        GazeLogHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = GazeLogMagic;
+        header.version = GazeLogVersion;
+        header.headerSize = sizeof(GazeLogHeader);
+        header.recordSize = sizeof(GazeLogRecord);
+
+        auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+        header.startTime = FileTimeUnixEpoch +
+            std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count() * 10;
+        return header;
+    }
+
+    bool validHeader(const GazeLogHeader& header)
+    {
+        return header.magic == GazeLogMagic &&
+               header.version == GazeLogVersion &&
+               header.headerSize == sizeof(GazeLogHeader) &&
+               header.recordSize == sizeof(GazeLogRecord);
+    }
+}
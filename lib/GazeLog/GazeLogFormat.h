@@ -0,0 +1,82 @@
+/*! \GazeLogFormat
+ *
+ * Binary gaze log, as written by Microsoft.HandsFree.Filters.LogFilter. The file is a
+ * GazeLogHeader followed by fixed size GazeLogRecords, appended as samples arrive. A log
+ * is complete up to its last whole record even if the writer never closed it.
+ *
+ * The layout must match GazeLog.cs in Microsoft.HandsFree.Sensors. All fields are little endian.
+ */
+
+#ifndef GAZELOG_GAZELOGFORMAT_H
+#define GAZELOG_GAZELOGFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace GazeLog
+{
+    const uint32_t GazeLogMagic = 0x474C5A47;   ///< "GZLG"
+    const uint16_t GazeLogVersion = 1;
+
+    struct GazeLogHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t headerSize;
+        uint32_t recordSize;
+        uint32_t reserved0;
+        int64_t startTime;          ///< When the log was started, as a UTC Windows file time.
+        uint8_t reserved[40];
+    };
+
+    enum GazeLogFlags : uint8_t
+    {
+        GAZE_LOG_HAS_DEVICE_DATA = 1,       ///< The device fields were filled in by the sensor.
+        GAZE_LOG_LEFT_EYE_DETECTED = 2,
+        GAZE_LOG_RIGHT_EYE_DETECTED = 4
+    };
+
+    /** \brief One gaze sample. x and y are normalized to the screen; the timestamp is in milliseconds.
+    The remaining fields are the IrisBond DATA_CALLBACK values and are zero unless GAZE_LOG_HAS_DEVICE_DATA is set.
+    */
+    struct GazeLogRecord
+    {
+        int64_t timestamp;
+        int64_t deviceTimestamp;
+        double x;
+        double y;
+        float rawX;                 ///< Tracker gaze point before its own smoothing, in screen pixels.
+        float rawY;
+        int32_t screenWidth;
+        int32_t screenHeight;
+        int32_t imageWidth;
+        int32_t imageHeight;
+        float leftEyeX;
+        float leftEyeY;
+        float leftEyeSize;
+        float rightEyeX;
+        float rightEyeY;
+        float rightEyeSize;
+        float distanceFactor;
+        uint8_t fixation;           ///< Microsoft.HandsFree.Sensors.Fixation: 0 unknown, 1 fixated, 2 not fixated.
+        uint8_t flags;              ///< GazeLogFlags
+        uint16_t reserved;
+    };
+
+    static_assert(sizeof(GazeLogHeader) == 64, "GazeLogHeader must match GazeLog.cs");
+    static_assert(offsetof(GazeLogHeader, startTime) == 16, "GazeLogHeader must match GazeLog.cs");
+    static_assert(sizeof(GazeLogRecord) == 88, "GazeLogRecord must match GazeLog.cs");
+    static_assert(offsetof(GazeLogRecord, rawX) == 32, "GazeLogRecord must match GazeLog.cs");
+    static_assert(offsetof(GazeLogRecord, leftEyeX) == 56, "GazeLogRecord must match GazeLog.cs");
+    static_assert(offsetof(GazeLogRecord, fixation) == 84, "GazeLogRecord must match GazeLog.cs");
+
+    /** \brief A header for a log started now.
+    */
+    GazeLogHeader makeHeader();
+
+    /** \brief False if the header is not one this version can read.
+    */
+    bool validHeader(const GazeLogHeader& header);
+}
+
+#endif //GAZELOG_GAZELOGFORMAT_H
@@ -0,0 +1,139 @@
+#include "GazeLogReader.h"
+
+#include <cstdio>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GazeLog
+{
+    GazeLogReader::GazeLogReader()
+        : _data(nullptr),
+          _size(0),
+          _records(nullptr),
+          _count(0)
+#ifdef WIN32
+          , _mapping(nullptr)
+#endif
+    {
+    }
+
+    GazeLogReader::~GazeLogReader()
+    {
+        close();
+    }
+
+    bool GazeLogReader::isGazeLog(const std::string& path)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        GazeLogHeader header;
+        bool valid = std::fread(&header, sizeof(header), 1, file) == 1 && validHeader(header);
+        std::fclose(file);
+        return valid;
+    }
+
+    bool GazeLogReader::open(const std::string& path)
+    {
+        close();
+
+#ifdef WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(GazeLogHeader)))
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr)
+        {
+            return false;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        _mapping = mapping;
+        _data = static_cast<const unsigned char*>(data);
+        _size = static_cast<size_t>(size.QuadPart);
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            return false;
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(GazeLogHeader)))
+        {
+            ::close(file);
+            return false;
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+        ::close(file);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+        madvise(data, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+
+        _data = static_cast<const unsigned char*>(data);
+        _size = static_cast<size_t>(status.st_size);
+#endif
+
+        if (!validHeader(header()))
+        {
+            close();
+            return false;
+        }
+
+        // Whole records only: a log that was being written when the process ended may end part way through one
+        _records = reinterpret_cast<const GazeLogRecord*>(_data + sizeof(GazeLogHeader));
+        _count = (_size - sizeof(GazeLogHeader)) / sizeof(GazeLogRecord);
+        return true;
+    }
+
+    void GazeLogReader::close()
+    {
+        if (_data == nullptr)
+        {
+            return;
+        }
+
+#ifdef WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+#else
+        munmap(const_cast<unsigned char*>(_data), _size);
+#endif
+        _data = nullptr;
+        _size = 0;
+        _records = nullptr;
+        _count = 0;
+    }
+}
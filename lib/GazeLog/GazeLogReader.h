@@ -0,0 +1,52 @@
+#ifndef GAZELOG_GAZELOGREADER_H
+#define GAZELOG_GAZELOGREADER_H
+
+#include "GazeLogFormat.h"
+
+#include <string>
+
+namespace GazeLog
+{
+    /** \brief Maps a gaze log into memory. The records are used in place, so opening a log
+    costs the same whatever its length.
+    */
+    class GazeLogReader
+    {
+    public:
+        GazeLogReader();
+        ~GazeLogReader();
+
+        GazeLogReader(const GazeLogReader&) = delete;
+        GazeLogReader& operator=(const GazeLogReader&) = delete;
+
+        /** \brief True if the file starts with a gaze log header.
+        */
+        static bool isGazeLog(const std::string& path);
+
+        /** \brief Map a log.
+        \return False if the file cannot be read or is not a gaze log.
+        */
+        bool open(const std::string& path);
+        void close();
+
+        const GazeLogHeader& header() const { return *reinterpret_cast<const GazeLogHeader*>(_data); }
+
+        /** \brief The number of whole records in the log.
+        */
+        size_t count() const { return _count; }
+
+        const GazeLogRecord* records() const { return _records; }
+        const GazeLogRecord& operator[](size_t index) const { return _records[index]; }
+
+    private:
+        const unsigned char* _data;
+        size_t _size;
+        const GazeLogRecord* _records;
+        size_t _count;
+#ifdef WIN32
+        void* _mapping;
+#endif
+    };
+}
+
+#endif //GAZELOG_GAZELOGREADER_H
@@ -0,0 +1,145 @@
+#include "GazeLogWriter.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace GazeLog
+{
+    namespace
+    {
+        const std::chrono::milliseconds FlushInterval(100);
+    }
+
+    GazeLogWriter::GazeLogWriter()
+        : _ring(new GazeLogRecord[RingCapacity]),
+          _head(0),
+          _tail(0),
+          _written(0),
+          _dropped(0),
+          _file(nullptr),
+          _buffer(BufferRecords),
+          _stopping(false)
+    {
+    }
+
+    GazeLogWriter::~GazeLogWriter()
+    {
+        close();
+    }
+
+    bool GazeLogWriter::open(const std::string& path)
+    {
+        close();
+
+        _file = std::fopen(path.c_str(), "wb");
+        if (_file == nullptr)
+        {
+            return false;
+        }
+
+        GazeLogHeader header = makeHeader();
+        if (std::fwrite(&header, sizeof(header), 1, _file) != 1 || std::fflush(_file) != 0)
+        {
+            std::fclose(_file);
+            _file = nullptr;
+            return false;
+        }
+
+        _head.store(0);
+        _tail.store(0);
+        _written.store(0);
+        _dropped.store(0);
+        _stopping = false;
+        _thread = std::thread(&GazeLogWriter::writerLoop, this);
+        return true;
+    }
+
+    void GazeLogWriter::close()
+    {
+        if (!_thread.joinable())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+
+        if (_file != nullptr)
+        {
+            std::fclose(_file);
+            _file = nullptr;
+        }
+    }
+
+    bool GazeLogWriter::write(const GazeLogRecord& record)
+    {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= RingCapacity)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _ring[head % RingCapacity] = record;
+        _head.store(head + 1, std::memory_order_release);
+
+        // The writer thread normally wakes on its own; only hurry it along if the disk has fallen behind
+        if (head - _tail.load(std::memory_order_relaxed) == RingCapacity / 2)
+        {
+            _wake.notify_one();
+        }
+        return true;
+    }
+
+    void GazeLogWriter::writerLoop()
+    {
+        bool stopping = false;
+        while (!stopping)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait_for(lock, FlushInterval);
+                stopping = _stopping;
+            }
+            drain();
+        }
+    }
+
+    void GazeLogWriter::drain()
+    {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        uint64_t tail = _tail.load(std::memory_order_relaxed);
+
+        while (tail != head)
+        {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(head - tail, BufferRecords));
+            for (size_t i = 0; i < count; i++)
+            {
+                _buffer[i] = _ring[(tail + i) % RingCapacity];
+            }
+
+            // The records are copied out, so their slots can be reused
+            tail += count;
+            _tail.store(tail, std::memory_order_release);
+
+            if (_file != nullptr && std::fwrite(_buffer.data(), sizeof(GazeLogRecord), count, _file) == count)
+            {
+                _written.fetch_add(count, std::memory_order_relaxed);
+            }
+            else
+            {
+                _dropped.fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+
+        // Hand the data to the operating system, so that it survives the process
+        if (_file != nullptr)
+        {
+            std::fflush(_file);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef GAZELOG_GAZELOGWRITER_H
+#define GAZELOG_GAZELOGWRITER_H
+
+#include "GazeLogFormat.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace GazeLog
+{
+    /** \brief Appends records to a gaze log. write() only copies the record into a lock-free
+    single producer ring; a background thread appends the ring to the file and hands it to the
+    operating system several times a second. When the ring is full records are dropped and counted.
+    */
+    class GazeLogWriter
+    {
+    public:
+        GazeLogWriter();
+        ~GazeLogWriter();
+
+        GazeLogWriter(const GazeLogWriter&) = delete;
+        GazeLogWriter& operator=(const GazeLogWriter&) = delete;
+
+        /** \brief Create the log, replacing any existing file, and start the writer thread.
+        */
+        bool open(const std::string& path);
+
+        /** \brief Write out everything queued and close the log.
+        */
+        void close();
+
+        /** \brief Queue a record. Only one thread may write to a log.
+        \return False if the record was dropped.
+        */
+        bool write(const GazeLogRecord& record);
+
+        /** \brief True if the next write() would be dropped. Writers that would rather wait than drop,
+        such as tools converting logs, can poll this.
+        */
+        bool full() const
+        {
+            return _head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_acquire) >= RingCapacity;
+        }
+
+        uint64_t written() const { return _written.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    private:
+        static const size_t RingCapacity = 8192;
+        static const size_t BufferRecords = 1024;
+
+        void writerLoop();
+        void drain();
+
+        std::unique_ptr<GazeLogRecord[]> _ring;
+        alignas(64) std::atomic<uint64_t> _head;
+        alignas(64) std::atomic<uint64_t> _tail;
+        std::atomic<uint64_t> _written;
+        std::atomic<uint64_t> _dropped;
+
+        std::FILE* _file;
+        std::vector<GazeLogRecord> _buffer;
+        std::thread _thread;
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        bool _stopping;
+    };
+}
+
+#endif //GAZELOG_GAZELOGWRITER_H
@@ -0,0 +1,295 @@
+#include "GazeTrace.h"
+
+#include "GazeLogReader.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+
+namespace IrisbondSim
+{
+    namespace
+    {
+        const double Pi = 3.14159265358979323846;
+
+        // Tracker noise on the raw gaze point, in pixels.
+        const double RawNoisePixels = 6.0;
+
+        // Time constant of the smoothing the tracker applies to produce mouseX/mouseY.
+        const double TrackerSmoothingMs = 40.0;
+    }
+
+    Random::Random(uint64_t seed)
+        : _state(seed ? seed : 0x9E3779B97F4A7C15ull)
+    {
+    }
+
+    uint64_t Random::next()
+    {
+        _state ^= _state >> 12;
+        _state ^= _state << 25;
+        _state ^= _state >> 27;
+        return _state * 0x2545F4914F6CDD1Dull;
+    }
+
+    double Random::uniform()
+    {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    double Random::uniform(double low, double high)
+    {
+        return low + (high - low) * uniform();
+    }
+
+    double Random::gaussian()
+    {
+        // Box-Muller; uniform() can return 0, so shift it into (0, 1].
+        double u1 = 1.0 - uniform();
+        double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * Pi * u2);
+    }
+
+    SyntheticGazeTrace::SyntheticGazeTrace(uint32_t seed, int screenWidth, int screenHeight)
+        : _random(0x5DEECE66Dull * (static_cast<uint64_t>(seed) + 1)),
+          _screenWidth(screenWidth),
+          _screenHeight(screenHeight),
+          _phase(Phase::Fixation),
+          _remainingMs(0),
+          _saccadeMs(0),
+          _fromX(screenWidth / 2.0), _fromY(screenHeight / 2.0),
+          _targetX(screenWidth / 2.0), _targetY(screenHeight / 2.0),
+          _gazeX(screenWidth / 2.0), _gazeY(screenHeight / 2.0),
+          _filteredX(screenWidth / 2.0), _filteredY(screenHeight / 2.0),
+          _elapsedMs(0)
+    {
+        beginFixation();
+    }
+
+    void SyntheticGazeTrace::beginFixation()
+    {
+        _phase = Phase::Fixation;
+        _remainingMs = _random.uniform(200, 800);
+    }
+
+    void SyntheticGazeTrace::next(double periodMs, GazeSample& sample)
+    {
+        _elapsedMs += periodMs;
+
+        switch (_phase)
+        {
+        case Phase::Fixation:
+            _gazeX = _targetX;
+            _gazeY = _targetY;
+            _remainingMs -= periodMs;
+            if (_remainingMs <= 0)
+            {
+                if (_random.uniform() < 0.1)
+                {
+                    _phase = Phase::Blink;
+                    _remainingMs = _random.uniform(100, 250);
+                }
+                else
+                {
+                    // Saccade duration grows roughly linearly with amplitude
+                    _fromX = _gazeX;
+                    _fromY = _gazeY;
+                    _targetX = _random.uniform(0.05, 0.95) * _screenWidth;
+                    _targetY = _random.uniform(0.05, 0.95) * _screenHeight;
+                    double amplitude = std::hypot(_targetX - _fromX, _targetY - _fromY);
+                    _saccadeMs = 20 + (amplitude * 0.02);
+                    _remainingMs = _saccadeMs;
+                    _phase = Phase::Saccade;
+                }
+            }
+            break;
+
+        case Phase::Saccade:
+            {
+                _remainingMs -= periodMs;
+                double progress = _remainingMs <= 0 ? 1.0 : 1.0 - (_remainingMs / _saccadeMs);
+                double eased = progress * progress * (3 - (2 * progress));
+                _gazeX = _fromX + ((_targetX - _fromX) * eased);
+                _gazeY = _fromY + ((_targetY - _fromY) * eased);
+                if (_remainingMs <= 0)
+                {
+                    beginFixation();
+                }
+            }
+            break;
+
+        case Phase::Blink:
+            _remainingMs -= periodMs;
+            if (_remainingMs <= 0)
+            {
+                beginFixation();
+            }
+            break;
+        }
+
+        bool detected = _phase != Phase::Blink;
+        double rawX = _filteredX;
+        double rawY = _filteredY;
+        if (detected)
+        {
+            rawX = _gazeX + (RawNoisePixels * _random.gaussian());
+            rawY = _gazeY + (RawNoisePixels * _random.gaussian());
+            double alpha = periodMs / (periodMs + TrackerSmoothingMs);
+            _filteredX += alpha * (rawX - _filteredX);
+            _filteredY += alpha * (rawY - _filteredY);
+        }
+
+        double drift = std::sin(_elapsedMs / 2000.0);
+
+        sample.timeMs = _elapsedMs;
+        sample.mouseX = static_cast<float>(_filteredX);
+        sample.mouseY = static_cast<float>(_filteredY);
+        sample.mouseRawX = static_cast<float>(rawX);
+        sample.mouseRawY = static_cast<float>(rawY);
+        sample.leftEyeDetected = detected;
+        sample.rightEyeDetected = detected;
+        sample.leftEyeX = static_cast<float>(0.42 + (0.01 * drift));
+        sample.leftEyeY = static_cast<float>(0.50 + (0.005 * drift));
+        sample.leftEyeSize = detected ? static_cast<float>(12.0 + (0.3 * _random.gaussian())) : 0.0f;
+        sample.rightEyeX = static_cast<float>(0.58 + (0.01 * drift));
+        sample.rightEyeY = static_cast<float>(0.50 + (0.005 * drift));
+        sample.rightEyeSize = detected ? static_cast<float>(12.0 + (0.3 * _random.gaussian())) : 0.0f;
+        sample.distanceFactor = static_cast<float>(0.1 * std::sin(_elapsedMs / 5000.0));
+    }
+
+    RecordedGazeTrace::RecordedGazeTrace(int screenWidth, int screenHeight)
+        : _screenWidth(screenWidth),
+          _screenHeight(screenHeight),
+          _index(0),
+          _loopOffsetMs(0)
+    {
+    }
+
+    bool RecordedGazeTrace::load(const std::string& path)
+    {
+        _samples.clear();
+        _index = 0;
+        _loopOffsetMs = 0;
+
+        bool loaded = GazeLog::GazeLogReader::isGazeLog(path) ? loadGazeLog(path) : loadTextLog(path);
+        return loaded && !_samples.empty();
+    }
+
+    bool RecordedGazeTrace::loadGazeLog(const std::string& path)
+    {
+        GazeLog::GazeLogReader reader;
+        if (!reader.open(path))
+        {
+            return false;
+        }
+
+        _samples.reserve(reader.count());
+        for (size_t i = 0; i < reader.count(); i++)
+        {
+            const GazeLog::GazeLogRecord& record = reader[i];
+            double timeMs = static_cast<double>(record.timestamp - reader[0].timestamp);
+            addSample(static_cast<float>(record.x), static_cast<float>(record.y), timeMs);
+
+            if (record.flags & GazeLog::GAZE_LOG_HAS_DEVICE_DATA)
+            {
+                GazeSample& sample = _samples.back();
+                sample.mouseRawX = record.rawX;
+                sample.mouseRawY = record.rawY;
+                sample.leftEyeDetected = (record.flags & GazeLog::GAZE_LOG_LEFT_EYE_DETECTED) != 0;
+                sample.rightEyeDetected = (record.flags & GazeLog::GAZE_LOG_RIGHT_EYE_DETECTED) != 0;
+                sample.leftEyeX = record.leftEyeX;
+                sample.leftEyeY = record.leftEyeY;
+                sample.leftEyeSize = record.leftEyeSize;
+                sample.rightEyeX = record.rightEyeX;
+                sample.rightEyeY = record.rightEyeY;
+                sample.rightEyeSize = record.rightEyeSize;
+                sample.distanceFactor = record.distanceFactor;
+            }
+        }
+        return true;
+    }
+
+    bool RecordedGazeTrace::loadTextLog(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::string line;
+        double firstTimestamp = 0;
+        while (std::getline(file, line))
+        {
+            const char* cursor = line.c_str();
+            char* end = nullptr;
+
+            double x = std::strtod(cursor, &end);
+            if (end == cursor || *end != ',')
+            {
+                continue;
+            }
+            cursor = end + 1;
+
+            double y = std::strtod(cursor, &end);
+            if (end == cursor || *end != ',')
+            {
+                continue;
+            }
+            cursor = end + 1;
+
+            double timestamp = std::strtod(cursor, &end);
+            if (end == cursor)
+            {
+                continue;
+            }
+
+            if (_samples.empty())
+            {
+                firstTimestamp = timestamp;
+            }
+            addSample(static_cast<float>(x), static_cast<float>(y), timestamp - firstTimestamp);
+        }
+        return true;
+    }
+
+    // A sample with the logged point and stand-in eye data, for logs that have none
+    void RecordedGazeTrace::addSample(float x, float y, double timeMs)
+    {
+        bool detected = !std::isnan(x) && !std::isnan(y);
+        float screenX = detected ? x * _screenWidth : 0.0f;
+        float screenY = detected ? y * _screenHeight : 0.0f;
+
+        GazeSample sample;
+        sample.timeMs = timeMs;
+        sample.mouseX = screenX;
+        sample.mouseY = screenY;
+        sample.mouseRawX = screenX;
+        sample.mouseRawY = screenY;
+        sample.leftEyeDetected = detected;
+        sample.rightEyeDetected = detected;
+        sample.leftEyeX = 0.42f;
+        sample.leftEyeY = 0.50f;
+        sample.leftEyeSize = detected ? 12.0f : 0.0f;
+        sample.rightEyeX = 0.58f;
+        sample.rightEyeY = 0.50f;
+        sample.rightEyeSize = detected ? 12.0f : 0.0f;
+        sample.distanceFactor = 0.0f;
+        _samples.push_back(sample);
+    }
+
+    void RecordedGazeTrace::next(double /*periodMs*/, GazeSample& sample)
+    {
+        sample = _samples[_index];
+        sample.timeMs += _loopOffsetMs;
+
+        if (++_index == _samples.size())
+        {
+            // Keep time moving forward across the loop, one average period after the last sample
+            double span = _samples.back().timeMs;
+            double period = _samples.size() > 1 ? span / (_samples.size() - 1) : 1000.0 / 30;
+            _loopOffsetMs += span + period;
+            _index = 0;
+        }
+    }
+}
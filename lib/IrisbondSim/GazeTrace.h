@@ -0,0 +1,134 @@
+#ifndef IRISBONDSIM_GAZETRACE_H
+#define IRISBONDSIM_GAZETRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace IrisbondSim
+{
+    /** \brief Small deterministic generator (xorshift64*), so a seed gives the same trace on every platform.
+    */
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed = 1);
+
+        uint64_t next();
+
+        /** \brief Uniform value in [0, 1).
+        */
+        double uniform();
+
+        /** \brief Uniform value in [low, high).
+        */
+        double uniform(double low, double high);
+
+        /** \brief Normally distributed value with mean 0 and standard deviation 1.
+        */
+        double gaussian();
+
+    private:
+        uint64_t _state;
+    };
+
+    /** \brief One simulated tracker sample, with the same fields as the DATA_CALLBACK.
+    Gaze coordinates are in pixels; eye positions are normalized to the camera image.
+    */
+    struct GazeSample
+    {
+        double timeMs;          ///< Offset from the start of the trace. Only meaningful for recorded traces.
+        float mouseX;
+        float mouseY;
+        float mouseRawX;
+        float mouseRawY;
+        bool leftEyeDetected;
+        bool rightEyeDetected;
+        float leftEyeX;
+        float leftEyeY;
+        float leftEyeSize;
+        float rightEyeX;
+        float rightEyeY;
+        float rightEyeSize;
+        float distanceFactor;
+    };
+
+    /** \brief Source of gaze samples for the simulator.
+    */
+    class GazeTrace
+    {
+    public:
+        virtual ~GazeTrace() = default;
+
+        /** \brief Produce the next sample.
+        \param[in] periodMs Time elapsed since the previous sample.
+        \param[out] sample The new sample.
+        */
+        virtual void next(double periodMs, GazeSample& sample) = 0;
+
+        /** \brief True when the samples carry their own timing in GazeSample::timeMs.
+        */
+        virtual bool hasTiming() const = 0;
+    };
+
+    /** \brief Fixations at random points on the screen joined by saccades, with tracker noise and
+    the occasional blink. The same seed and periods always give the same samples.
+    */
+    class SyntheticGazeTrace : public GazeTrace
+    {
+    public:
+        SyntheticGazeTrace(uint32_t seed, int screenWidth, int screenHeight);
+
+        void next(double periodMs, GazeSample& sample) override;
+        bool hasTiming() const override { return false; }
+
+    private:
+        enum class Phase { Fixation, Saccade, Blink };
+
+        void beginFixation();
+
+        Random _random;
+        int _screenWidth;
+        int _screenHeight;
+        Phase _phase;
+        double _remainingMs;
+        double _saccadeMs;
+        double _fromX, _fromY;
+        double _targetX, _targetY;
+        double _gazeX, _gazeY;
+        double _filteredX, _filteredY;
+        double _elapsedMs;
+    };
+
+    /** \brief Replays a gaze log written by LogFilter, either a binary gaze log or a text log from an
+    earlier version with one "x, y, timestamp" line per sample, x and y normalized to the screen.
+    Binary logs also replay the eye data when they have it. The trace loops when it reaches the end.
+    */
+    class RecordedGazeTrace : public GazeTrace
+    {
+    public:
+        RecordedGazeTrace(int screenWidth, int screenHeight);
+
+        /** \brief Load the samples from a log file.
+        \return False if the file could not be read or holds no samples.
+        */
+        bool load(const std::string& path);
+
+        void next(double periodMs, GazeSample& sample) override;
+        bool hasTiming() const override { return true; }
+
+    private:
+        bool loadGazeLog(const std::string& path);
+        bool loadTextLog(const std::string& path);
+
+        void addSample(float x, float y, double timeMs);
+
+        int _screenWidth;
+        int _screenHeight;
+        std::vector<GazeSample> _samples;
+        size_t _index;
+        double _loopOffsetMs;
+    };
+}
+
+#endif //IRISBONDSIM_GAZETRACE_H
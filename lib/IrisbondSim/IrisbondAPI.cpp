@@ -0,0 +1,367 @@
+//
+// Simulated implementation of every function declared in IrisbondAPI.h. Gaze data comes
+// from the Simulator; the calibration, positioning and LED functions only keep enough
+// state to behave plausibly for a caller that has no camera attached.
+//
+
+#include "IrisbondSim.h"
+#include "Simulator.h"
+
+#include <atomic>
+#include <string>
+
+using namespace IrisbondAPI;
+using IrisbondSim::Simulator;
+
+namespace
+{
+    const char* const HardwareNumber = "IRIS00000000";
+    const char* const CameraKeyword = "SIMULATOR";
+    const int FocusDistance = 60;
+
+    std::atomic<int> _calibrationPoints{ 0 };
+    std::atomic<bool> _calibrationCancelled{ false };
+    std::atomic<bool> _ledLightsOn{ true };
+
+    std::atomic<CALIBRATION_RESULTS_CALLBACK> _calibrationResultsCallback{ nullptr };
+    std::atomic<CALIBRATION_RESULTS_POINTS_CALLBACK> _calibrationResultsPointsCallback{ nullptr };
+    std::atomic<CALIBRATION_CANCELLED_CALLBACK> _calibrationCancelledCallback{ nullptr };
+    std::atomic<CALIBRATION_TARGET_CALLBACK> _calibrationTargetCallback{ nullptr };
+    std::atomic<CALIBRATION_POINT_ERROR_CALLBACK> _calibrationPointErrorCallback{ nullptr };
+}
+
+extern "C" {
+    namespace IrisbondAPI
+    {
+        API bool trackerIsPresent()
+        {
+            return true;
+        }
+
+        API const char* getHardwareNumber()
+        {
+            return HardwareNumber;
+        }
+
+        API const char* getCameraKeyword()
+        {
+            return CameraKeyword;
+        }
+
+        API int getCameraFocusDistance()
+        {
+            return FocusDistance;
+        }
+
+        API START_STATUS start()
+        {
+            return Simulator::instance().start();
+        }
+
+        API void stop()
+        {
+            Simulator::instance().stop();
+        }
+
+        API void showPositioningWindow()
+        {
+        }
+
+        API void hidePositioningWindow()
+        {
+        }
+
+        API void setCalibrationParameters(double /*travelTime*/, double /*fixationTime*/)
+        {
+        }
+
+        API void setCalibrationColors(uint32_t /*targetColor*/, uint32_t /*backgroundColor*/)
+        {
+        }
+
+        API void setTargetSize(int /*targetSize*/)
+        {
+        }
+
+        API void setLocalTargetImage(int /*index*/)
+        {
+        }
+
+        API bool loadTargetImage(const char* /*pathToImage*/)
+        {
+            return true;
+        }
+
+        API void setLocalTargetAnimation()
+        {
+        }
+
+        API bool loadTargetAnimationSpriteSheet(const char* /*pathToAnimation*/, int /*frames*/, float /*loopTime*/)
+        {
+            return true;
+        }
+
+        API void startCalibration(int numCalibPoints)
+        {
+            _calibrationCancelled.store(false);
+            _calibrationPoints.store(numCalibPoints);
+        }
+
+        API void cancelCalibration()
+        {
+            _calibrationCancelled.store(true);
+        }
+
+        API void startImproveCalibration()
+        {
+            startCalibration(3);
+        }
+
+        API void startCalibrationRectification()
+        {
+            startCalibration(1);
+        }
+
+        API CALIBRATION_STATUS waitForCalibrationToEnd(int /*timeoutInMinutes*/)
+        {
+            const auto config = Simulator::instance().config();
+            int points = _calibrationPoints.exchange(0);
+
+            // Visit the points on a regular grid, then report a perfect calibration
+            int columns = points >= 9 ? (points == 16 ? 4 : 3) : points;
+            int rows = columns > 0 ? (points + columns - 1) / columns : 0;
+            auto target = _calibrationTargetCallback.load();
+            for (int i = 0; i < points && !_calibrationCancelled.load(); i++)
+            {
+                if (target != nullptr)
+                {
+                    double x = (i % columns + 0.5) / columns * config.screenWidth;
+                    double y = (i / columns + 0.5) / rows * config.screenHeight;
+                    target(x, y, config.screenWidth, config.screenHeight, false);
+                    target(x, y, config.screenWidth, config.screenHeight, true);
+                }
+            }
+
+            if (_calibrationCancelled.load())
+            {
+                auto cancelled = _calibrationCancelledCallback.load();
+                if (cancelled != nullptr)
+                {
+                    cancelled();
+                }
+                auto results = _calibrationResultsCallback.load();
+                if (results != nullptr)
+                {
+                    results(0, 0, 0, 0, 0, 0, true);
+                }
+                return CALIBRATION_STATUS::CALIBRATION_CANCELLED;
+            }
+
+            auto results = _calibrationResultsCallback.load();
+            if (results != nullptr)
+            {
+                results(0, 0, 0, 0, 0, 0, false);
+            }
+            return CALIBRATION_STATUS::CALIBRATION_FINISHED;
+        }
+
+        API void showCalibrationGUI(bool /*show*/)
+        {
+        }
+
+        API void showCalibrationPointErrorGUI(bool /*show*/)
+        {
+        }
+
+        API void showCalibrationResultsGUI(bool /*show*/)
+        {
+        }
+
+        API void setStepByStepCalibration(bool /*step*/)
+        {
+        }
+
+        API void resumeCalibration()
+        {
+        }
+
+        API const char* getDefaultCalibrationChar()
+        {
+            return Simulator::DefaultCalibration;
+        }
+
+        API const char* getCalibrationChar()
+        {
+            // The returned text stays valid until this thread asks again
+            thread_local std::string calibration;
+            calibration = Simulator::instance().calibration();
+            return calibration.c_str();
+        }
+
+        API void loadCalibrationChar(char* calibrationChar)
+        {
+            Simulator::instance().setCalibration(calibrationChar != nullptr ? calibrationChar : Simulator::DefaultCalibration);
+        }
+
+        API void loadDefaultCalibrationChar()
+        {
+            Simulator::instance().setCalibration(Simulator::DefaultCalibration);
+        }
+
+        API void startTesting(int /*userDistance*/)
+        {
+        }
+
+        API void setTestingRecording(bool /*record*/)
+        {
+        }
+
+        API bool setUserEyeControlMode(CONTROLLING_EYE /*controlMode*/)
+        {
+            return true;
+        }
+
+        API void setSmoothValue(int /*smooth*/)
+        {
+        }
+
+        API void setBlinkConfiguration(double singleTime, double cancelTime, bool bothEyesRequired)
+        {
+            Simulator::instance().setBlinkConfiguration(singleTime, cancelTime, bothEyesRequired);
+        }
+
+        API void setDwellConfiguration(int areaPixels, double time, bool bothEyesRequired)
+        {
+            Simulator::instance().setDwellConfiguration(areaPixels, time, bothEyesRequired);
+        }
+
+        API void setHighPerformanceMode(bool enable)
+        {
+            Simulator::instance().setHighPerformanceMode(enable);
+        }
+
+        API bool isHighPerformanceMode()
+        {
+            return Simulator::instance().isHighPerformanceMode();
+        }
+
+        API void setDataCallback(DATA_CALLBACK theCallback)
+        {
+            Simulator::instance().dataCallback.store(theCallback);
+        }
+
+        API void setCalibrationResultsCallback(CALIBRATION_RESULTS_CALLBACK theCallback)
+        {
+            _calibrationResultsCallback.store(theCallback);
+        }
+
+        API void setCalibrationResultsPointsCallback(CALIBRATION_RESULTS_POINTS_CALLBACK theCallback)
+        {
+            _calibrationResultsPointsCallback.store(theCallback);
+        }
+
+        API void setCalibrationCancelledCallback(CALIBRATION_CANCELLED_CALLBACK theCallback)
+        {
+            _calibrationCancelledCallback.store(theCallback);
+        }
+
+        API void setCalibrationTargetCallback(CALIBRATION_TARGET_CALLBACK theCallback)
+        {
+            _calibrationTargetCallback.store(theCallback);
+        }
+
+        API void setCalibrationPointErrorCallback(CALIBRATION_POINT_ERROR_CALLBACK theCallback)
+        {
+            _calibrationPointErrorCallback.store(theCallback);
+        }
+
+        API void setImageCallback(IMAGE_CALLBACK theCallback)
+        {
+            Simulator::instance().imageCallback.store(theCallback);
+        }
+
+        API void setBlinkCallback(BLINK_CALLBACK theCallback)
+        {
+            Simulator::instance().blinkCallback.store(theCallback);
+        }
+
+        API void setDwellCallback(DWELL_CALLBACK theCallback)
+        {
+            Simulator::instance().dwellCallback.store(theCallback);
+        }
+
+        API bool isApplicationEnded()
+        {
+            return !Simulator::instance().isRunning();
+        }
+
+        API bool switchOnLedLights()
+        {
+            _ledLightsOn.store(true);
+            return true;
+        }
+
+        API bool switchOffLedLights()
+        {
+            _ledLightsOn.store(false);
+            return true;
+        }
+
+        API bool areLedLightsOn()
+        {
+            return _ledLightsOn.load();
+        }
+
+        API void setLicense(const char* /*license*/)
+        {
+        }
+    }
+}
+
+extern "C" {
+    namespace IrisbondSim
+    {
+        API void setSimulationRate(double rateHz)
+        {
+            Simulator::instance().setRate(rateHz);
+        }
+
+        API void setSimulationJitter(double jitterMs)
+        {
+            Simulator::instance().setJitter(jitterMs);
+        }
+
+        API void setSimulationSeed(uint32_t seed)
+        {
+            Simulator::instance().setSeed(seed);
+        }
+
+        API void setSimulationLateThreshold(double lateMs)
+        {
+            Simulator::instance().setLateThreshold(lateMs);
+        }
+
+        API void setSimulationFreeRun(bool freeRun)
+        {
+            Simulator::instance().setFreeRun(freeRun);
+        }
+
+        API bool loadSimulationTrace(const char* path)
+        {
+            return Simulator::instance().loadTrace(path);
+        }
+
+        API void getSimulationStats(SIMULATION_STATS* stats)
+        {
+            if (stats != nullptr)
+            {
+                Simulator::instance().getStats(*stats);
+            }
+        }
+
+        API void resetSimulationStats()
+        {
+            Simulator::instance().resetStats();
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*! \IrisbondSim
+ *
+ * Simulated IrisbondAPI backend. Builds as a drop-in replacement for IrisbondAPI.dll
+ * that drives the DATA_CALLBACK from synthetic or recorded gaze traces, so the
+ * callback path can be exercised without a Duo camera.
+ *
+ * The simulator reads its initial configuration from the environment when start()
+ * is called:
+ *
+ *   IRISBOND_SIM_RATE      Sample rate in Hz (default 60). 0 replays a recorded
+ *                          trace with its own timing.
+ *   IRISBOND_SIM_JITTER    Uniform jitter applied to every sample deadline, +/- ms.
+ *   IRISBOND_SIM_SEED      Seed for the synthetic trace and the jitter (default 1).
+ *   IRISBOND_SIM_TRACE     Recorded trace to replay instead of the synthetic one.
+ *   IRISBOND_SIM_LATE_MS   Delivery delay after which a callback counts as late.
+ *   IRISBOND_SIM_FREERUN   Non-zero delivers samples back to back, ignoring the rate.
+ *
+ * The functions below override the environment and expose the delivery statistics.
+ */
+
+#ifndef IRISBONDSIM_H
+#define IRISBONDSIM_H
+
+#include <cstdint>
+
+#if !defined(WIN32) && !defined(API)
+    #define API __attribute__((visibility("default")))
+#endif
+
+#include "IrisbondAPI.h"
+
+extern "C" {
+    namespace IrisbondSim
+    {
+        /** \brief Callback delivery statistics collected since start() or resetSimulationStats().
+        All latencies are in microseconds.
+        */
+        struct SIMULATION_STATS
+        {
+            uint64_t delivered;         ///< Data callbacks delivered.
+            uint64_t dropped;           ///< Samples skipped because the previous callback overran their slot.
+            uint64_t late;              ///< Callbacks delivered later than the late threshold.
+            double latenessP50;         ///< Median delay between a sample deadline and the callback entry.
+            double latenessP99;         ///< 99th percentile of the delivery delay.
+            double latenessMax;         ///< Largest delivery delay.
+            double callbackP50;         ///< Median time spent inside the data callback.
+            double callbackP99;         ///< 99th percentile of the time spent inside the data callback.
+            double callbackMax;         ///< Longest data callback.
+            double effectiveRate;       ///< Delivered callbacks per second of wall-clock time.
+        };
+
+        /** \brief Set the sample rate.
+        \param[in] rateHz Samples per second, typically 60 to 1000. 0 replays a recorded trace with its own timing.
+        */
+        API void setSimulationRate(double rateHz);
+
+        /** \brief Set the deadline jitter.
+        \param[in] jitterMs Every sample deadline is moved by a uniform amount in [-jitterMs, jitterMs].
+        */
+        API void setSimulationJitter(double jitterMs);
+
+        /** \brief Set the seed used for the synthetic trace and the jitter. The same seed gives the same samples.
+        */
+        API void setSimulationSeed(uint32_t seed);
+
+        /** \brief Set the delivery delay after which a callback is counted as late.
+        \param[in] lateMs Threshold in milliseconds. Defaults to half a sample period.
+        */
+        API void setSimulationLateThreshold(double lateMs);
+
+        /** \brief Deliver samples back to back instead of pacing them, to measure the throughput of the callback path.
+        */
+        API void setSimulationFreeRun(bool freeRun);
+
+        /** \brief Replay a recorded trace instead of the synthetic one.
+        \param[in] path Path to a gaze log written by LogFilter. Null restores the synthetic trace.
+        \return True if the trace was loaded.
+        */
+        API bool loadSimulationTrace(const char* path);
+
+        /** \brief Get the delivery statistics.
+        */
+        API void getSimulationStats(SIMULATION_STATS* stats);
+
+        /** \brief Clear the delivery statistics.
+        */
+        API void resetSimulationStats();
+    }
+}
+
+#endif //IRISBONDSIM_H
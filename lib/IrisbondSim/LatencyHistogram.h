@@ -0,0 +1,117 @@
+#ifndef IRISBONDSIM_LATENCYHISTOGRAM_H
+#define IRISBONDSIM_LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace IrisbondSim
+{
+    /** \brief Histogram of microsecond values that can be recorded from one thread and read from another.
+    Values below 16 get a bucket each; above that every power of two is split into 8 buckets, so
+    percentiles are reported to within 12.5%.
+    */
+    class LatencyHistogram
+    {
+    public:
+        LatencyHistogram()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& count : _counts)
+            {
+                count.store(0, std::memory_order_relaxed);
+            }
+            _total.store(0, std::memory_order_relaxed);
+            _max.store(0, std::memory_order_relaxed);
+        }
+
+        void record(uint64_t value)
+        {
+            _counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+            _total.fetch_add(1, std::memory_order_relaxed);
+
+            uint64_t max = _max.load(std::memory_order_relaxed);
+            while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        uint64_t count() const
+        {
+            return _total.load(std::memory_order_relaxed);
+        }
+
+        uint64_t max() const
+        {
+            return _max.load(std::memory_order_relaxed);
+        }
+
+        /** \brief Value below which the given fraction of the recorded values fall.
+        \param[in] fraction Between 0 and 1, e.g. 0.99 for the 99th percentile.
+        */
+        double percentile(double fraction) const
+        {
+            uint64_t total = count();
+            if (total == 0)
+            {
+                return 0;
+            }
+
+            uint64_t rank = static_cast<uint64_t>(fraction * (total - 1)) + 1;
+            uint64_t seen = 0;
+            for (int i = 0; i < BucketCount; i++)
+            {
+                seen += _counts[i].load(std::memory_order_relaxed);
+                if (seen >= rank)
+                {
+                    double upper = static_cast<double>(upperBoundOf(i));
+                    double max = static_cast<double>(this->max());
+                    return upper < max ? upper : max;
+                }
+            }
+            return static_cast<double>(max());
+        }
+
+    private:
+        static const int LinearBuckets = 16;
+        static const int SubBuckets = 8;
+        static const int BucketCount = LinearBuckets + (64 - 4) * SubBuckets;
+
+        static int bucketOf(uint64_t value)
+        {
+            if (value < LinearBuckets)
+            {
+                return static_cast<int>(value);
+            }
+
+            int exponent = 63;
+            while ((value >> exponent) == 0)
+            {
+                exponent--;
+            }
+            int sub = static_cast<int>((value >> (exponent - 3)) & (SubBuckets - 1));
+            return LinearBuckets + (exponent - 4) * SubBuckets + sub;
+        }
+
+        static uint64_t upperBoundOf(int bucket)
+        {
+            if (bucket < LinearBuckets)
+            {
+                return static_cast<uint64_t>(bucket);
+            }
+
+            int exponent = (bucket - LinearBuckets) / SubBuckets + 4;
+            uint64_t sub = static_cast<uint64_t>((bucket - LinearBuckets) % SubBuckets);
+            return ((SubBuckets + sub + 1) << (exponent - 3)) - 1;
+        }
+
+        std::atomic<uint64_t> _counts[BucketCount];
+        std::atomic<uint64_t> _total;
+        std::atomic<uint64_t> _max;
+    };
+}
+
+#endif //IRISBONDSIM_LATENCYHISTOGRAM_H
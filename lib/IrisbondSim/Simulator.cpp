@@ -0,0 +1,528 @@
+#include "Simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace IrisbondSim
+{
+    namespace
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        // Rate the tracker falls back to when high performance mode is disabled.
+        const double StandardModeRateHz = 60;
+
+        // Below this the scheduler spins instead of sleeping, since sleeps overshoot.
+        const auto SpinThreshold = std::chrono::milliseconds(2);
+
+        bool readEnvironment(const char* name, double& value)
+        {
+            const char* text = std::getenv(name);
+            if (text == nullptr || *text == '\0')
+            {
+                return false;
+            }
+
+            char* end = nullptr;
+            double parsed = std::strtod(text, &end);
+            if (end == text)
+            {
+                return false;
+            }
+
+            value = parsed;
+            return true;
+        }
+
+        int64_t nowNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+        }
+
+        void waitUntil(Clock::time_point due)
+        {
+            for (;;)
+            {
+                auto remaining = due - Clock::now();
+                if (remaining <= Clock::duration::zero())
+                {
+                    return;
+                }
+
+                if (remaining > SpinThreshold)
+                {
+                    std::this_thread::sleep_for(remaining - SpinThreshold / 2);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        uint64_t microseconds(Clock::duration duration)
+        {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+            return us > 0 ? static_cast<uint64_t>(us) : 0;
+        }
+    }
+
+    Simulator& Simulator::instance()
+    {
+        static Simulator simulator;
+        return simulator;
+    }
+
+    void Simulator::applyEnvironment()
+    {
+        double value;
+        if (!(_overrides & RateSet) && readEnvironment("IRISBOND_SIM_RATE", value))
+        {
+            _config.rateHz = value;
+        }
+        if (!(_overrides & JitterSet) && readEnvironment("IRISBOND_SIM_JITTER", value))
+        {
+            _config.jitterMs = value;
+        }
+        if (!(_overrides & SeedSet) && readEnvironment("IRISBOND_SIM_SEED", value))
+        {
+            _config.seed = static_cast<uint32_t>(value);
+        }
+        if (!(_overrides & LateSet) && readEnvironment("IRISBOND_SIM_LATE_MS", value))
+        {
+            _config.lateThresholdMs = value;
+        }
+        if (!(_overrides & FreeRunSet) && readEnvironment("IRISBOND_SIM_FREERUN", value))
+        {
+            _config.freeRun = value != 0;
+        }
+        if (!(_overrides & TraceSet))
+        {
+            const char* trace = std::getenv("IRISBOND_SIM_TRACE");
+            if (trace != nullptr)
+            {
+                _config.tracePath = trace;
+            }
+        }
+    }
+
+    IrisbondAPI::START_STATUS Simulator::start()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_running.load())
+        {
+            return IrisbondAPI::START_STATUS::START_OK;
+        }
+
+        // A processing loop stopped from inside its own callback is still finishing. It cannot
+        // wait for itself, so a restart from that callback is refused.
+        if (_threadActive)
+        {
+            if (_threadId == std::this_thread::get_id())
+            {
+                return IrisbondAPI::START_STATUS::CAMERA_IN_USE;
+            }
+            _threadExited.wait(lock, [this] { return !_threadActive; });
+        }
+
+        applyEnvironment();
+
+        if (_config.tracePath.empty())
+        {
+            _trace.reset(new SyntheticGazeTrace(_config.seed, _config.screenWidth, _config.screenHeight));
+        }
+        else if (_loadedTrace && _loadedTracePath == _config.tracePath)
+        {
+            _trace.reset(new RecordedGazeTrace(*_loadedTrace));
+        }
+        else
+        {
+            auto recorded = new RecordedGazeTrace(_config.screenWidth, _config.screenHeight);
+            _trace.reset(recorded);
+            if (!recorded->load(_config.tracePath))
+            {
+                _trace.reset();
+                return IrisbondAPI::START_STATUS::CAMERA_ERROR;
+            }
+        }
+
+        _closedSinceMs = -1;
+        _dwellStartMs = -1;
+        _dwellFired = false;
+        resetStats();
+
+        _running.store(true);
+        _threadActive = true;
+        _thread = std::thread(&Simulator::run, this, _config);
+        _threadId = _thread.get_id();
+        return IrisbondAPI::START_STATUS::START_OK;
+    }
+
+    void Simulator::stop()
+    {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running.store(false);
+            thread = std::move(_thread);
+        }
+
+        // The lock is not held here, since the processing loop takes it on its way out
+        if (!thread.joinable())
+        {
+            return;
+        }
+
+        // stop() may be called from inside one of our own callbacks
+        if (thread.get_id() == std::this_thread::get_id())
+        {
+            thread.detach();
+        }
+        else
+        {
+            thread.join();
+        }
+    }
+
+    void Simulator::setRate(double rateHz)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config.rateHz = rateHz;
+        _overrides |= RateSet;
+    }
+
+    void Simulator::setJitter(double jitterMs)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config.jitterMs = jitterMs;
+        _overrides |= JitterSet;
+    }
+
+    void Simulator::setSeed(uint32_t seed)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config.seed = seed;
+        _overrides |= SeedSet;
+    }
+
+    void Simulator::setLateThreshold(double lateMs)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config.lateThresholdMs = lateMs;
+        _overrides |= LateSet;
+    }
+
+    void Simulator::setFreeRun(bool freeRun)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config.freeRun = freeRun;
+        _overrides |= FreeRunSet;
+    }
+
+    bool Simulator::loadTrace(const char* path)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config.tracePath = path != nullptr ? path : "";
+        _overrides |= TraceSet;
+
+        _loadedTrace.reset();
+        _loadedTracePath.clear();
+        if (path == nullptr)
+        {
+            return true;
+        }
+
+        std::unique_ptr<RecordedGazeTrace> trace(new RecordedGazeTrace(_config.screenWidth, _config.screenHeight));
+        if (!trace->load(path))
+        {
+            return false;
+        }
+
+        _loadedTrace = std::move(trace);
+        _loadedTracePath = _config.tracePath;
+        return true;
+    }
+
+    void Simulator::setBlinkConfiguration(double singleTime, double cancelTime, bool bothEyesRequired)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config.blinkMinMs = singleTime * 1000;
+        _config.blinkMaxMs = cancelTime * 1000;
+        _config.blinkBothEyes = bothEyesRequired;
+    }
+
+    void Simulator::setDwellConfiguration(int areaPixels, double time, bool bothEyesRequired)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config.dwellAreaPixels = areaPixels;
+        _config.dwellMs = time * 1000;
+        _config.dwellBothEyes = bothEyesRequired;
+    }
+
+    SimulatorConfig Simulator::config() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _config;
+    }
+
+    std::string Simulator::calibration() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _calibration;
+    }
+
+    void Simulator::setCalibration(const char* calibration)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _calibration = calibration;
+    }
+
+    double Simulator::effectiveRate(const SimulatorConfig& config) const
+    {
+        double rate = config.rateHz;
+        if (!_highPerformance.load() && (rate <= 0 || rate > StandardModeRateHz))
+        {
+            rate = StandardModeRateHz;
+        }
+        return rate;
+    }
+
+    void Simulator::getStats(SIMULATION_STATS& stats) const
+    {
+        stats.delivered = _delivered.load();
+        stats.dropped = _dropped.load();
+        stats.late = _late.load();
+        stats.latenessP50 = _lateness.percentile(0.50);
+        stats.latenessP99 = _lateness.percentile(0.99);
+        stats.latenessMax = static_cast<double>(_lateness.max());
+        stats.callbackP50 = _callbackTime.percentile(0.50);
+        stats.callbackP99 = _callbackTime.percentile(0.99);
+        stats.callbackMax = static_cast<double>(_callbackTime.max());
+
+        double seconds = (nowNs() - _statsStartNs.load()) / 1e9;
+        stats.effectiveRate = seconds > 0 ? stats.delivered / seconds : 0;
+    }
+
+    void Simulator::resetStats()
+    {
+        _delivered.store(0);
+        _dropped.store(0);
+        _late.store(0);
+        _lateness.reset();
+        _callbackTime.reset();
+        _statsStartNs.store(nowNs());
+    }
+
+    void Simulator::run(SimulatorConfig config)
+    {
+        loop(config);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threadActive = false;
+        _threadExited.notify_all();
+    }
+
+    void Simulator::loop(const SimulatorConfig& config)
+    {
+        double rate = effectiveRate(config);
+        bool traceTiming = rate <= 0 && _trace->hasTiming();
+        if (rate <= 0)
+        {
+            rate = StandardModeRateHz;
+        }
+
+        const double periodMs = 1000.0 / rate;
+        const double lateMs = config.lateThresholdMs >= 0 ? config.lateThresholdMs : periodMs / 2;
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(periodMs));
+        const auto late = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(lateMs));
+
+        Random jitter(0x2545F4914F6CDD1Dull ^ config.seed);
+
+        const long long epochMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        const auto start = Clock::now();
+        double lastDueMs = 0;
+
+        for (uint64_t slot = 0; _running.load(); slot++)
+        {
+            // The trace advances for every slot, including the dropped ones, so the
+            // samples are the same whatever the consumer does.
+            GazeSample sample;
+            _trace->next(periodMs, sample);
+
+            double dueMs = traceTiming ? sample.timeMs : slot * periodMs;
+            if (config.jitterMs > 0)
+            {
+                dueMs += jitter.uniform(-config.jitterMs, config.jitterMs);
+            }
+            dueMs = std::max(dueMs, lastDueMs);
+            lastDueMs = dueMs;
+
+            const auto due = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(dueMs));
+
+            if (!config.freeRun)
+            {
+                // A slot that went by entirely while the previous callback was still running
+                // is lost, just as the camera drops frames the processing loop cannot take.
+                if (Clock::now() - due > period)
+                {
+                    _dropped.fetch_add(1);
+                    continue;
+                }
+
+                waitUntil(due);
+
+                auto lateness = Clock::now() - due;
+                _lateness.record(microseconds(lateness));
+                if (lateness > late)
+                {
+                    _late.fetch_add(1);
+                }
+            }
+
+            deliver(config, epochMs + std::llround(dueMs), sample);
+        }
+    }
+
+    void Simulator::deliver(const SimulatorConfig& config, long long timestamp, const GazeSample& sample)
+    {
+        auto image = imageCallback.load();
+        if (image != nullptr)
+        {
+            renderImage(config, sample);
+            image(_image.data(), config.imageHeight, config.imageWidth, 1, timestamp);
+        }
+
+        auto data = dataCallback.load();
+        if (data != nullptr)
+        {
+            auto entry = Clock::now();
+            data(timestamp,
+                sample.mouseX, sample.mouseY,
+                sample.mouseRawX, sample.mouseRawY,
+                config.screenWidth, config.screenHeight,
+                sample.leftEyeDetected, sample.rightEyeDetected,
+                config.imageWidth, config.imageHeight,
+                sample.leftEyeX, sample.leftEyeY, sample.leftEyeSize,
+                sample.rightEyeX, sample.rightEyeY, sample.rightEyeSize,
+                sample.distanceFactor);
+            _callbackTime.record(microseconds(Clock::now() - entry));
+        }
+        _delivered.fetch_add(1);
+
+        double timeMs = static_cast<double>(timestamp);
+        detectBlink(config, sample, timeMs);
+        detectDwell(config, sample, timeMs);
+    }
+
+    void Simulator::detectBlink(const SimulatorConfig& config, const GazeSample& sample, double timeMs)
+    {
+        bool closed = config.blinkBothEyes
+            ? (!sample.leftEyeDetected && !sample.rightEyeDetected)
+            : (!sample.leftEyeDetected || !sample.rightEyeDetected);
+
+        if (closed)
+        {
+            if (_closedSinceMs < 0)
+            {
+                _closedSinceMs = timeMs;
+            }
+            return;
+        }
+
+        if (_closedSinceMs >= 0)
+        {
+            double closedMs = timeMs - _closedSinceMs;
+            auto blink = blinkCallback.load();
+            if (blink != nullptr && closedMs >= config.blinkMinMs && closedMs <= config.blinkMaxMs)
+            {
+                blink(static_cast<int>(_lastOpenX), static_cast<int>(_lastOpenY), config.screenWidth, config.screenHeight);
+            }
+            _closedSinceMs = -1;
+        }
+
+        _lastOpenX = sample.mouseX;
+        _lastOpenY = sample.mouseY;
+    }
+
+    void Simulator::detectDwell(const SimulatorConfig& config, const GazeSample& sample, double timeMs)
+    {
+        bool tracked = config.dwellBothEyes
+            ? (sample.leftEyeDetected && sample.rightEyeDetected)
+            : (sample.leftEyeDetected || sample.rightEyeDetected);
+
+        if (!tracked)
+        {
+            _dwellStartMs = -1;
+            return;
+        }
+
+        double distance = std::hypot(sample.mouseX - _dwellX, sample.mouseY - _dwellY);
+        if (_dwellStartMs < 0 || distance > config.dwellAreaPixels)
+        {
+            _dwellX = sample.mouseX;
+            _dwellY = sample.mouseY;
+            _dwellStartMs = timeMs;
+            _dwellFired = false;
+            return;
+        }
+
+        auto dwell = dwellCallback.load();
+        if (!_dwellFired && dwell != nullptr && timeMs - _dwellStartMs >= config.dwellMs)
+        {
+            dwell(static_cast<int>(_dwellX), static_cast<int>(_dwellY), config.screenWidth, config.screenHeight);
+            _dwellFired = true;
+        }
+    }
+
+    void Simulator::renderImage(const SimulatorConfig& config, const GazeSample& sample)
+    {
+        const int width = config.imageWidth;
+        const int height = config.imageHeight;
+        _image.resize(static_cast<size_t>(width) * height);
+        std::memset(_image.data(), 40, _image.size());
+
+        auto drawEye = [&](bool detected, float x, float y, float size)
+        {
+            if (!detected)
+            {
+                return;
+            }
+
+            // Dark pupil with a bright corneal glint at its upper left
+            int cx = static_cast<int>(x * width);
+            int cy = static_cast<int>(y * height);
+            int radius = std::max(1, static_cast<int>(size / 2));
+            for (int dy = -radius; dy <= radius; dy++)
+            {
+                int row = cy + dy;
+                if (row < 0 || row >= height)
+                {
+                    continue;
+                }
+                for (int dx = -radius; dx <= radius; dx++)
+                {
+                    int col = cx + dx;
+                    if (col >= 0 && col < width && (dx * dx) + (dy * dy) <= radius * radius)
+                    {
+                        _image[static_cast<size_t>(row) * width + col] = 10;
+                    }
+                }
+            }
+
+            int gx = cx - radius / 3;
+            int gy = cy - radius / 3;
+            if (gx >= 0 && gx + 1 < width && gy >= 0 && gy + 1 < height)
+            {
+                char* glint = &_image[static_cast<size_t>(gy) * width + gx];
+                glint[0] = glint[1] = glint[width] = glint[width + 1] = static_cast<char>(255);
+            }
+        };
+
+        drawEye(sample.leftEyeDetected, sample.leftEyeX, sample.leftEyeY, sample.leftEyeSize);
+        drawEye(sample.rightEyeDetected, sample.rightEyeX, sample.rightEyeY, sample.rightEyeSize);
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef IRISBONDSIM_SIMULATOR_H
+#define IRISBONDSIM_SIMULATOR_H
+
+#include "IrisbondSim.h"
+#include "GazeTrace.h"
+#include "LatencyHistogram.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace IrisbondSim
+{
+    struct SimulatorConfig
+    {
+        double rateHz = 60;
+        double jitterMs = 0;
+        uint32_t seed = 1;
+        double lateThresholdMs = -1;    ///< Negative means half a sample period.
+        bool freeRun = false;
+        std::string tracePath;
+        int screenWidth = 1920;
+        int screenHeight = 1080;
+        int imageWidth = 640;
+        int imageHeight = 480;
+        double blinkMinMs = 300;
+        double blinkMaxMs = 1000;
+        bool blinkBothEyes = false;
+        double dwellAreaPixels = 30;
+        double dwellMs = 1000;
+        bool dwellBothEyes = false;
+    };
+
+    /** \brief The state behind the exported IrisbondAPI functions. A single instance drives the
+    callbacks from a dedicated thread, like the tracker's processing loop. The processing loop
+    takes a copy of the configuration when it starts, so changes apply from the next start().
+    */
+    class Simulator
+    {
+    public:
+        static Simulator& instance();
+
+        /** \brief Apply the IRISBOND_SIM_* environment variables on top of the current configuration.
+        Values set through the IrisbondSim functions take precedence.
+        */
+        void applyEnvironment();
+
+        IrisbondAPI::START_STATUS start();
+        void stop();
+        bool isRunning() const { return _running.load(); }
+
+        void setRate(double rateHz);
+        void setJitter(double jitterMs);
+        void setSeed(uint32_t seed);
+        void setLateThreshold(double lateMs);
+        void setFreeRun(bool freeRun);
+        bool loadTrace(const char* path);
+        void setHighPerformanceMode(bool enable) { _highPerformance.store(enable); }
+        bool isHighPerformanceMode() const { return _highPerformance.load(); }
+
+        void setBlinkConfiguration(double singleTime, double cancelTime, bool bothEyesRequired);
+        void setDwellConfiguration(int areaPixels, double time, bool bothEyesRequired);
+
+        std::atomic<IrisbondAPI::DATA_CALLBACK> dataCallback{ nullptr };
+        std::atomic<IrisbondAPI::IMAGE_CALLBACK> imageCallback{ nullptr };
+        std::atomic<IrisbondAPI::BLINK_CALLBACK> blinkCallback{ nullptr };
+        std::atomic<IrisbondAPI::DWELL_CALLBACK> dwellCallback{ nullptr };
+
+        /** \brief A copy of the current configuration, since the setters may change it concurrently. */
+        SimulatorConfig config() const;
+
+        /** \brief The calibration reported until another is loaded. */
+        static constexpr const char* DefaultCalibration = "SIMULATED";
+
+        /** \brief The calibration data returned by getCalibrationChar(). */
+        std::string calibration() const;
+        void setCalibration(const char* calibration);
+
+        void getStats(SIMULATION_STATS& stats) const;
+        void resetStats();
+
+    private:
+        Simulator() = default;
+
+        void run(SimulatorConfig config);
+        void loop(const SimulatorConfig& config);
+        double effectiveRate(const SimulatorConfig& config) const;
+        void deliver(const SimulatorConfig& config, long long timestamp, const GazeSample& sample);
+        void detectBlink(const SimulatorConfig& config, const GazeSample& sample, double timeMs);
+        void detectDwell(const SimulatorConfig& config, const GazeSample& sample, double timeMs);
+        void renderImage(const SimulatorConfig& config, const GazeSample& sample);
+
+        // Settings explicitly made through the API, so the environment does not override them
+        enum Override
+        {
+            RateSet = 1,
+            JitterSet = 2,
+            SeedSet = 4,
+            LateSet = 8,
+            FreeRunSet = 16,
+            TraceSet = 32
+        };
+
+        mutable std::mutex _mutex;
+        SimulatorConfig _config;
+        unsigned _overrides = 0;
+        std::string _calibration = DefaultCalibration;
+        std::unique_ptr<GazeTrace> _trace;
+
+        // The trace parsed by loadTrace(), copied by start() while the path is unchanged
+        std::unique_ptr<RecordedGazeTrace> _loadedTrace;
+        std::string _loadedTracePath;
+
+        std::thread _thread;
+        std::atomic<bool> _running{ false };
+
+        // Set from start() until the processing loop has returned, even if its thread was detached
+        bool _threadActive = false;
+        std::thread::id _threadId;
+        std::condition_variable _threadExited;
+        std::atomic<bool> _highPerformance{ true };
+
+        double _closedSinceMs = -1;
+        float _lastOpenX = 0;
+        float _lastOpenY = 0;
+
+        double _dwellStartMs = -1;
+        float _dwellX = 0;
+        float _dwellY = 0;
+        bool _dwellFired = false;
+
+        std::vector<char> _image;
+
+        std::atomic<uint64_t> _delivered{ 0 };
+        std::atomic<uint64_t> _dropped{ 0 };
+        std::atomic<uint64_t> _late{ 0 };
+        std::atomic<int64_t> _statsStartNs{ 0 };
+        LatencyHistogram _lateness;
+        LatencyHistogram _callbackTime;
+    };
+}
+
+#endif //IRISBONDSIM_SIMULATOR_H
@@ -52,7 +52,7 @@ namespace Microsoft.HandsFree.Filters
                 fixation = Fixation.True;
             }
 
-            return new GazeEventArgs(_filteredX, _filteredY, gazeArgs.Timestamp, fixation, true);
+            return new GazeEventArgs(_filteredX, _filteredY, gazeArgs, fixation, true);
         }
     }
 }
@@ -6,32 +6,40 @@ namespace Microsoft.HandsFree.Filters
     public class GazeStats
     {
         int _count;
-        Point _sum;
-        Point _sumSquared;
+        Point _mean;
+        Point _sumSquaredDeviations;
 
         public GazeStats()
         {
             _count = 0;
-            _sum = new Point();
-            _sumSquared = new Point();
+            _mean = new Point();
+            _sumSquaredDeviations = new Point();
         }
 
         public void Reset()
         {
             _count = 0;
-            _sum.X = 0;
-            _sum.Y = 0;
-            _sumSquared.X = 0;
-            _sumSquared.Y = 0;
+            _mean.X = 0;
+            _mean.Y = 0;
+            _sumSquaredDeviations.X = 0;
+            _sumSquaredDeviations.Y = 0;
         }
 
+        //
+        // Welford's update: the running mean and the sum of squared deviations from it stay
+        // accurate however many samples are added, where E[X^2] - (E[X])^2 loses precision
+        // as the sums grow and can even go negative.
+        //
         public void Update(double x, double y)
         {
-            _sum.X += x;
-            _sum.Y += y;
-            _sumSquared.X += x * x;
-            _sumSquared.Y += y * y;
             _count++;
+
+            double deltaX = x - _mean.X;
+            double deltaY = y - _mean.Y;
+            _mean.X += deltaX / _count;
+            _mean.Y += deltaY / _count;
+            _sumSquaredDeviations.X += deltaX * (x - _mean.X);
+            _sumSquaredDeviations.Y += deltaY * (y - _mean.Y);
         }
 
         public int Count
@@ -42,19 +50,18 @@ namespace Microsoft.HandsFree.Filters
 
         public Point Mean
         {
-            get { return new Point(_sum.X / _count, _sum.Y / _count); }
+            get { return _count != 0 ? _mean : new Point(double.NaN, double.NaN); }
         }
 
         //
-        // StdDev = sqrt(Variance) = sqrt(E[X^2]  (E[X])^2)
+        // StdDev = sqrt(Variance), the population variance being the mean squared deviation
         //
         public Point StandardDeviation
         {
             get
             {
-                Point mean = this.Mean;
-                return new Point(Math.Sqrt((_sumSquared.X / _count) - (mean.X * mean.X)),
-                                 Math.Sqrt((_sumSquared.Y / _count) - (mean.Y * mean.Y)));
+                return new Point(Math.Sqrt(_sumSquaredDeviations.X / _count),
+                                 Math.Sqrt(_sumSquaredDeviations.Y / _count));
             }
         }
     }
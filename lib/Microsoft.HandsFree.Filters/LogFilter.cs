@@ -1,5 +1,7 @@
 using Microsoft.HandsFree.Sensors;
-using System.Collections.Generic;
+using System;
+using System.ComponentModel;
+using System.Diagnostics;
 using System.IO;
 using System.Windows;
 
@@ -7,40 +9,89 @@ namespace Microsoft.HandsFree.Filters
 {
     public class LogFilter :  IFilter
     {
+        private static readonly TraceSource _trace = new TraceSource("LogFilter", SourceLevels.Information);
+
         private Point _dummyStatsPoint;
-        private int _maxLogEntries;
-        private List<GazeEventArgs> _logEntries;
+        private readonly object _logLock = new object();
+        private GazeLogWriter _logWriter;
+        private bool _logUnavailable;
+        private LoggingSettings _loggingSettings = new LoggingSettings();
         public Settings Settings = new Settings();
-        // TODO: Make this follow the settings pattern.
-        public LoggingSettings LoggingSettings = new LoggingSettings();
+
+        public LoggingSettings LoggingSettings
+        {
+            get { return _loggingSettings; }
+            set
+            {
+                _loggingSettings.PropertyChanged -= OnLoggingSettingsChanged;
+                _loggingSettings = value;
+                _loggingSettings.PropertyChanged += OnLoggingSettingsChanged;
+                CloseLog();
+            }
+        }
 
         public void Initialize()
         {
             _dummyStatsPoint = new Point();
-            _logEntries = new List<GazeEventArgs>();
-            _maxLogEntries = LoggingSettings.LogDuration * 30 * 60; // N minutes at 30fps
         }
 
         public void Terminate()
         {
-            StreamWriter logFile = new StreamWriter(LoggingSettings.GazeDataLogFile, false);
-            foreach (GazeEventArgs entry in _logEntries)
-            {
-                logFile.WriteLine($"{entry.Scaled.X}, {entry.Scaled.Y}, {entry.Timestamp}");
-            }
-            logFile.Close();
+            CloseLog();
         }
 
         public GazeEventArgs Update(GazeEventArgs gazeArgs)
         {
-            _logEntries.Add(gazeArgs);
-            if (_logEntries.Count > _maxLogEntries)
+            // The log is opened by the first sample logged, and again after the log settings change.
+            // Samples are appended as they arrive; the log rolls over every LogDuration minutes.
+            // The lock also keeps GazeLogWriter to one producer when more than one thread logs.
+            lock (_logLock)
             {
-                _logEntries.RemoveAt(0);
+                if (_logWriter == null && !_logUnavailable && _loggingSettings.LogGazeData)
+                {
+                    OpenLog();
+                }
+
+                _logWriter?.Write(gazeArgs);
             }
             return gazeArgs.Clone();
         }
 
+        private void OnLoggingSettingsChanged(object sender, PropertyChangedEventArgs e)
+        {
+            if (e.PropertyName == nameof(LoggingSettings.LogGazeData) ||
+                e.PropertyName == nameof(LoggingSettings.GazeDataLogFile) ||
+                e.PropertyName == nameof(LoggingSettings.LogDuration))
+            {
+                CloseLog();
+            }
+        }
+
+        private void OpenLog()
+        {
+            try
+            {
+                _logWriter = new GazeLogWriter(_loggingSettings.GazeDataLogFile, TimeSpan.FromMinutes(_loggingSettings.LogDuration));
+            }
+            catch (Exception ex) when (ex is IOException || ex is UnauthorizedAccessException)
+            {
+                // Samples go on through unlogged rather than failing again on every one
+                _trace.TraceInformation("Cannot create {0}: {1}", _loggingSettings.GazeDataLogFile, ex.Message);
+                _logUnavailable = true;
+            }
+        }
+
+        // Settings change on the UI thread while samples are logged on the sensor thread
+        private void CloseLog()
+        {
+            lock (_logLock)
+            {
+                _logWriter?.Dispose();
+                _logWriter = null;
+                _logUnavailable = false;
+            }
+        }
+
         public Point StandardDeviationOriginal()
         {
             return _dummyStatsPoint;
@@ -105,7 +105,7 @@ namespace Microsoft.HandsFree.Filters
             Point filteredPoint = _pointFilter.Update(gazeArgs.Scaled, distanceAlpha);
 
             // compute the new args
-            var newArgs = new GazeEventArgs(filteredPoint.X, filteredPoint.Y, gazeArgs.Timestamp, Fixation.Unknown, true);
+            var newArgs = new GazeEventArgs(filteredPoint.X, filteredPoint.Y, gazeArgs, Fixation.Unknown, true);
             return newArgs;
         }
 
@@ -121,7 +121,7 @@ namespace Microsoft.HandsFree.Filters
                 ? Fixation.True
                 : Fixation.False;
 
-            return new GazeEventArgs(ptOldest.X, ptOldest.Y, gazeArgs.Timestamp, fixation, true);
+            return new GazeEventArgs(ptOldest.X, ptOldest.Y, gazeArgs, fixation, true);
         }
     }
 }
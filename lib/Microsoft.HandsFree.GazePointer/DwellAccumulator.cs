@@ -0,0 +1,193 @@
+using System;
+using System.Collections.Generic;
+
+namespace Microsoft.HandsFree.GazePointer
+{
+    /// <summary>
+    /// Time the gaze has spent on each target within a sliding window of samples. Each sample
+    /// credits the time since the sample before it to its own target, and samples that fall out
+    /// of the window take their time with them.
+    /// The samples are kept in a ring, so adding and evicting are constant time, and each target
+    /// present in the window is given a small integer id that indexes its total. Consecutive
+    /// samples on the same target, which is nearly all of them, need no lookup at all.
+    /// </summary>
+    public class DwellAccumulator<T> where T : class
+    {
+        struct Sample
+        {
+            public int Target;
+            public long Timestamp;
+            public int Duration;
+        }
+
+        private const int InitialCapacity = 256;
+
+        private Sample[] _samples = new Sample[InitialCapacity];
+        private int _first;
+        private int _count;
+
+        // per target id: the target, its total time and how many samples in the window are on it
+        private readonly Dictionary<T, int> _ids = new Dictionary<T, int>();
+        private T[] _targets = new T[16];
+        private int[] _times = new int[16];
+        private int[] _sampleCounts = new int[16];
+        private readonly Stack<int> _freeIds = new Stack<int>();
+        private int _nextId;
+
+        private T _lastTarget;
+        private int _lastId;
+
+        /// <param name="window">Length of the window, in the units of the timestamps.</param>
+        public DwellAccumulator(long window)
+        {
+            Window = window;
+            MaxInterval = int.MaxValue;
+        }
+
+        /// <summary>
+        /// Samples are evicted once they are more than this older than the newest sample.
+        /// </summary>
+        public long Window { get; set; }
+
+        /// <summary>
+        /// Most time credited for a single sample, however long it has been since the one before.
+        /// </summary>
+        public int MaxInterval { get; set; }
+
+        /// <summary>
+        /// Samples in the window.
+        /// </summary>
+        public int Count { get { return _count; } }
+
+        /// <summary>
+        /// Targets with samples in the window.
+        /// </summary>
+        public int TargetCount { get { return _ids.Count; } }
+
+        /// <summary>
+        /// Lengthen the window if it is shorter than the given time; it is never shortened.
+        /// </summary>
+        public void ExtendWindow(long window)
+        {
+            if (window > Window)
+            {
+                Window = window;
+            }
+        }
+
+        /// <summary>
+        /// Add the newest sample.
+        /// </summary>
+        /// <returns>The time the target has accumulated within the window.</returns>
+        public int Add(T target, long timestamp)
+        {
+            int duration = 0;
+            if (_count != 0)
+            {
+                long interval = timestamp - _samples[(_first + _count - 1) & (_samples.Length - 1)].Timestamp;
+                duration = (int)Math.Min(interval, MaxInterval);
+            }
+
+            int id = IdOf(target);
+            if (_count == _samples.Length)
+            {
+                Grow();
+            }
+
+            _samples[(_first + _count) & (_samples.Length - 1)] = new Sample { Target = id, Timestamp = timestamp, Duration = duration };
+            _count++;
+            _times[id] += duration;
+            _sampleCounts[id]++;
+
+            // drop the oldest samples until only those within the window remain
+            while (timestamp - _samples[_first].Timestamp > Window)
+            {
+                Sample oldest = _samples[_first];
+                _first = (_first + 1) & (_samples.Length - 1);
+                _count--;
+
+                _times[oldest.Target] -= oldest.Duration;
+                if (--_sampleCounts[oldest.Target] == 0)
+                {
+                    ReleaseId(oldest.Target);
+                }
+            }
+
+            return _times[id];
+        }
+
+        /// <summary>
+        /// The time a target has accumulated within the window.
+        /// </summary>
+        public int TimeOf(T target)
+        {
+            int id;
+            return _ids.TryGetValue(target, out id) ? _times[id] : 0;
+        }
+
+        public void Clear()
+        {
+            Array.Clear(_targets, 0, _nextId);
+            Array.Clear(_times, 0, _nextId);
+            Array.Clear(_sampleCounts, 0, _nextId);
+            _ids.Clear();
+            _freeIds.Clear();
+            _nextId = 0;
+            _first = 0;
+            _count = 0;
+            _lastTarget = null;
+        }
+
+        private int IdOf(T target)
+        {
+            if (ReferenceEquals(target, _lastTarget))
+            {
+                return _lastId;
+            }
+
+            int id;
+            if (!_ids.TryGetValue(target, out id))
+            {
+                id = _freeIds.Count != 0 ? _freeIds.Pop() : _nextId++;
+                if (id == _targets.Length)
+                {
+                    Array.Resize(ref _targets, id * 2);
+                    Array.Resize(ref _times, id * 2);
+                    Array.Resize(ref _sampleCounts, id * 2);
+                }
+
+                _ids.Add(target, id);
+                _targets[id] = target;
+            }
+
+            _lastTarget = target;
+            _lastId = id;
+            return id;
+        }
+
+        private void ReleaseId(int id)
+        {
+            T target = _targets[id];
+            _ids.Remove(target);
+            _targets[id] = null;
+            _times[id] = 0;
+            _freeIds.Push(id);
+
+            if (ReferenceEquals(target, _lastTarget))
+            {
+                _lastTarget = null;
+            }
+        }
+
+        private void Grow()
+        {
+            var samples = new Sample[_samples.Length * 2];
+            for (int i = 0; i < _count; i++)
+            {
+                samples[i] = _samples[(_first + i) & (_samples.Length - 1)];
+            }
+            _samples = samples;
+            _first = 0;
+        }
+    }
+}
@@ -1,7 +1,9 @@
 using System;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.IO;
 using System.Runtime.InteropServices;
+using System.Threading;
 using System.Windows;
 using System.Windows.Automation.Peers;
 using System.Windows.Automation.Provider;
@@ -17,13 +19,6 @@ using FormsScreen = System.Windows.Forms.Screen;
 
 namespace Microsoft.HandsFree.GazePointer
 {
-    class GazeHistoryItem
-    {
-        public FrameworkElement HitTarget;
-        public long Timestamp;
-        public int Duration;
-    }
-
     public class GazePointer
     {
         static IntPtr _hwndCursor;
@@ -40,6 +35,11 @@ namespace Microsoft.HandsFree.GazePointer
         public GazeStats OriginalSignal { get; private set; }
         public GazeStats FilteredSignal { get; private set; }
 
+        /// <summary>
+        /// Latency from the sensor callback to each stage of gaze handling, for every gaze pointer.
+        /// </summary>
+        public static GazeLatencyMonitor Latency { get; } = new GazeLatencyMonitor();
+
         const long InvokeEffectiveTickCounts = 250;
         static long _lastInvokeTickCount = Environment.TickCount - InvokeEffectiveTickCounts;
 
@@ -56,6 +56,8 @@ namespace Microsoft.HandsFree.GazePointer
 
         private static readonly TraceSource _trace = new TraceSource("GazePointer", SourceLevels.Information);
         private static IGazeDataProvider _gazeDataProvider;
+        // Shared by every GazePointer. GazeLogWriter takes a single producer, so the filter
+        // serializes its writes in case samples are logged from more than one sensor thread.
         private static readonly LogFilter _logFilter;
 
         private static GazeCursorElement _gazeCursor;
@@ -77,17 +79,34 @@ namespace Microsoft.HandsFree.GazePointer
         private bool _wasTracking;
 
         private IFilter _xyFilter;
+        private readonly GazeEventQueue _gazeQueue = new GazeEventQueue();
+        private int _dispatchPending;
         private GazeClickParameters _defaultClickParams;
         private GetGazeClickParameters _getGazeClickParams;
 
         private FrameworkElement _hitTarget;
         private DependencyObject _nextVisualHit = null;
+
+        // screen bounds of the gaze targets in the window, refreshed after layout changes
+        private readonly GazeTargetIndex<FrameworkElement> _targetIndex = new GazeTargetIndex<FrameworkElement>();
+        private bool _targetIndexDirty = true;
+        private int _targetIndexLayoutVersion;
+
+        // Changes when an element anywhere is loaded, unloaded or resized, which is when targets can move
+        private static int _layoutVersion;
+
+        // the last target the full hit test agreed with the index on, and the targets it has disagreed on
+        // since the index was refreshed, for which the index is not trusted
+        private FrameworkElement _confirmedTarget;
+        private readonly HashSet<FrameworkElement> _unconfirmedTargets = new HashSet<FrameworkElement>();
         private GazeMouseState _gazeMouseState;
 
-        private List<GazeHistoryItem> _gazeHistory;
-        private Dictionary<FrameworkElement, int> _hitTargetTimes;
+        // time spent on each hit target over the last second or so, in milliseconds
+        private DwellAccumulator<FrameworkElement> _gazeHistory;
 
-        long _maxHistoryTime = 1000; // in milliseconds
+        // Longest gap between samples credited to a hit target, so that a stalled UI thread or a
+        // break in tracking does not count as dwelling on whatever is looked at next
+        const int MaxSampleInterval = 100; // in milliseconds
         readonly IdleDetector _idleDetector = new IdleDetector(TimeSpan.FromSeconds(0.25));
 
         public static readonly DependencyProperty GazeElementProperty = DependencyProperty.RegisterAttached("GazeElement", typeof(FrameworkElement), typeof(GazePointer));
@@ -115,7 +134,7 @@ namespace Microsoft.HandsFree.GazePointer
 
             if (_gazeDataProvider == null)
             {
-                _gazeDataProvider = GazeDataProvider.InitializeGazeDataProvider(settings.Sensor);
+                _gazeDataProvider = GazeDataProvider.InitializeGazeDataProvider(settings.Sensor, settings.Logging);
             }
 
             return new GazePointer(
@@ -136,8 +155,9 @@ namespace Microsoft.HandsFree.GazePointer
         {
             _cursorWindow.Close();
             _mouseListener.Terminate();
-            _logFilter.Terminate();
+            // samples are logged on the sensor thread, so stop it before closing the log
             _gazeDataProvider.Terminate();
+            _logFilter.Terminate();
         }
 
         static GazePointer()
@@ -146,6 +166,14 @@ namespace Microsoft.HandsFree.GazePointer
             
             _logFilter = new LogFilter();
             _logFilter.Initialize();
+
+            // LayoutUpdated is raised for every layout pass, including ones that move nothing, so
+            // the target index is refreshed when an element is loaded, unloaded or resized, and on
+            // scrolling. A margin, Canvas position, transform or collapsing sibling can move a target
+            // without any of these, which GetHitTarget checks for before it keeps an indexed target.
+            EventManager.RegisterClassHandler(typeof(FrameworkElement), FrameworkElement.LoadedEvent, new RoutedEventHandler((o, args) => _layoutVersion++));
+            EventManager.RegisterClassHandler(typeof(FrameworkElement), FrameworkElement.UnloadedEvent, new RoutedEventHandler((o, args) => _layoutVersion++));
+            EventManager.RegisterClassHandler(typeof(FrameworkElement), FrameworkElement.SizeChangedEvent, new SizeChangedEventHandler((o, args) => _layoutVersion++));
            
             CreateCursorWindow();
             _offScreenElement = new FrameworkElement();
@@ -168,13 +196,11 @@ namespace Microsoft.HandsFree.GazePointer
         private readonly Window _window;
         private Window _mainWindow;
         private IntPtr _hwndMain;
-        private bool _windowClosed;
+        private volatile bool _windowClosed;
 
         private GazePointer(Window window, GazeClickParameters clickParameters, GetGazeClickParameters getGazeClickParameters,
             Settings settings, bool forceMouseCursor)
         {
-            // TODO: Addition of loggingSettings with default as parameter WILL have introduced logging configuration bug.
-
             _settings = settings;
             _sensorSettings = settings.Sensor;
             _filterSettings = settings.Filter;
@@ -188,6 +214,7 @@ namespace Microsoft.HandsFree.GazePointer
 
             _settings.PropertyChanged += (o, args) => _window.Dispatcher.BeginInvoke(new GazePointerDelegate(UpdateCursorStyle));
             _filterSettings.PropertyChanged += (o, args) => _logFilter.Settings = _filterSettings;
+            _logFilter.LoggingSettings = _loggingSettings;
 
             _window = window;
             _windowClosed = false;
@@ -199,6 +226,7 @@ namespace Microsoft.HandsFree.GazePointer
 
             window.LocationChanged += OnWindowLocationOrSizeChanged;
             window.SizeChanged += OnWindowLocationOrSizeChanged;
+            window.AddHandler(ScrollViewer.ScrollChangedEvent, new ScrollChangedEventHandler((o, args) => _targetIndexDirty = true), true);
             window.Closed += OnWindowClosed;
 
             UpdateCursorStyle();
@@ -230,8 +258,7 @@ namespace Microsoft.HandsFree.GazePointer
 
             _xyFilter = InitializeFilter();
 
-            _gazeHistory = new List<GazeHistoryItem>();
-            _hitTargetTimes = new Dictionary<FrameworkElement, int>();
+            _gazeHistory = new DwellAccumulator<FrameworkElement>(1000) { MaxInterval = MaxSampleInterval };
             _hitTarget = _offScreenElement;
 
             _gazeDataProvider.GazeEvent += OnGazeData;
@@ -376,6 +403,18 @@ namespace Microsoft.HandsFree.GazePointer
         {
             _windowClosed = true;
             _gazeDataProvider.GazeEvent -= OnGazeData;
+
+            if (_loggingSettings.LogLatency)
+            {
+                try
+                {
+                    Latency.Dump(_loggingSettings.LatencyLogFile);
+                }
+                catch (IOException ex)
+                {
+                    _trace.TraceInformation("EXCEPTION: {0}", ex.Message);
+                }
+            }
         }
 
         private void OnWindowLocationOrSizeChanged(object sender, EventArgs e)
@@ -384,6 +423,7 @@ namespace Microsoft.HandsFree.GazePointer
 
             _topLeft = _reverseTransform.Transform(new Point(window.Left, window.Top));
             _bottomRight = _reverseTransform.Transform(new Point(window.Left + window.ActualWidth, window.Top + window.ActualHeight));
+            _targetIndexDirty = true;
         }
 
         private void FireEyesOn()
@@ -494,6 +534,17 @@ namespace Microsoft.HandsFree.GazePointer
             }
         }
 
+        /// <summary>
+        /// Filtered samples waiting for the UI thread, with counts of those it skipped.
+        /// </summary>
+        public GazeEventQueue GazeQueue
+        {
+            get
+            {
+                return _gazeQueue;
+            }
+        }
+
         void SendMouseInput(Point point, User32.MOUSEEVENTF flags, long timestamp)
         {
             User32.INPUT[] input = new User32.INPUT[1];
@@ -505,11 +556,52 @@ namespace Microsoft.HandsFree.GazePointer
             User32.SendInput(1, input, Marshal.SizeOf(typeof(User32.INPUT)));
         }
 
-        delegate void GazeDataDelegate(GazeEventArgs e);
-
+        //
+        // Samples are logged and filtered on the sensor thread as they arrive, then queued for
+        // the UI thread. Only one drain of the queue is waiting on the dispatcher at a time, and
+        // it handles only the newest sample, so the UI thread never works through a backlog of
+        // stale samples after a stall.
+        //
         void OnGazeData(object sender, GazeEventArgs e)
         {
-            _window.Dispatcher.BeginInvoke(new GazeDataDelegate(GazeDataHandler), e);
+            // sensors that do not stamp their callbacks are timed from here
+            if (e.Stages.CallbackEntry == 0)
+            {
+                e.Stages.CallbackEntry = GazeStageTimestamps.Now;
+            }
+
+            // a sample already on its way when the window closed is neither logged nor filtered
+            if (_windowClosed)
+            {
+                return;
+            }
+
+            // if logging is turned on, log the original data, not the filtered data
+            if ((_sensorSettings.Sensor != Sensors.Sensors.LogPlayback) && (_loggingSettings.LogGazeData))
+            {
+                _logFilter.Update(e);
+            }
+
+            GazeEventArgs ev = _xyFilter.Update(e);
+            ev.Stages.FilterExit = GazeStageTimestamps.Now;
+
+            _gazeQueue.Enqueue(ev);
+            if (Interlocked.Exchange(ref _dispatchPending, 1) == 0)
+            {
+                _window.Dispatcher.BeginInvoke(new GazePointerDelegate(DrainGazeQueue));
+            }
+        }
+
+        void DrainGazeQueue()
+        {
+            // cleared first, so a sample queued from here on schedules another drain
+            Volatile.Write(ref _dispatchPending, 0);
+
+            GazeEventArgs ev;
+            if (_gazeQueue.TryTakeLatest(out ev))
+            {
+                GazeDataHandler(ev);
+            }
         }
 
         public HitTestResultBehavior GazeHitTestResultFilter(HitTestResult hitResult)
@@ -526,6 +618,11 @@ namespace Microsoft.HandsFree.GazePointer
             }
         }
 
+        static bool IsGazeTarget(DependencyObject element)
+        {
+            return (element is Button) || (element is ToggleButton) || (element is TextBox) || (element is TabItem);
+        }
+
         public FrameworkElement GetRootElement(DependencyObject initial)
         {
             DependencyObject current = initial;
@@ -550,7 +647,7 @@ namespace Microsoft.HandsFree.GazePointer
                 }
 
                 // stop enumeration if we encounter a FrameworkElement type we care about
-                if ((current is Button) || (current is ToggleButton) || (current is TextBox) || (current is TabItem))
+                if (IsGazeTarget(current))
                 {
                     result = current;
                     break;
@@ -702,19 +799,19 @@ namespace Microsoft.HandsFree.GazePointer
         {
             // Update the max total time we are maintaining if we ever see a click param higher than what we have.
             const int PAD_HISTORY = 500;// add a padding of time (in milliseconds) so that the history is slightly larger and includes the largest click param value
-            if ((clickParams.RepeatMouseDownDelay + PAD_HISTORY > _maxHistoryTime) && (clickParams.RepeatMouseDownDelay != uint.MaxValue))
+            if (clickParams.RepeatMouseDownDelay != uint.MaxValue)
             {
-                _maxHistoryTime = clickParams.RepeatMouseDownDelay + PAD_HISTORY; 
+                _gazeHistory.ExtendWindow(clickParams.RepeatMouseDownDelay + PAD_HISTORY);
             }
 
-            if ((clickParams.MouseUpDelay + PAD_HISTORY > _maxHistoryTime) && (clickParams.MouseUpDelay != uint.MaxValue))
+            if (clickParams.MouseUpDelay != uint.MaxValue)
             {
-                _maxHistoryTime = clickParams.MouseUpDelay + PAD_HISTORY; 
+                _gazeHistory.ExtendWindow(clickParams.MouseUpDelay + PAD_HISTORY);
             }
 
-            if ((clickParams.MouseDownDelay + PAD_HISTORY > _maxHistoryTime) && (clickParams.MouseDownDelay != uint.MaxValue))
+            if (clickParams.MouseDownDelay != uint.MaxValue)
             {
-                _maxHistoryTime = clickParams.MouseDownDelay + PAD_HISTORY;
+                _gazeHistory.ExtendWindow(clickParams.MouseDownDelay + PAD_HISTORY);
             }
         }
 
@@ -729,8 +826,98 @@ namespace Microsoft.HandsFree.GazePointer
             }
         }
 
+        /// <summary>
+        /// Bring the target index up to date with the visual tree. Targets are numbered in the
+        /// order they are drawn, so a target drawn over another, or nested inside it, wins.
+        /// </summary>
+        void UpdateTargetIndex()
+        {
+            if (!_targetIndexDirty && _targetIndexLayoutVersion == _layoutVersion)
+            {
+                return;
+            }
+
+            _targetIndexDirty = false;
+            _targetIndexLayoutVersion = _layoutVersion;
+            _unconfirmedTargets.Clear();
+            _confirmedTarget = null;
+
+            _targetIndex.BeginUpdate();
+            int order = 0;
+            AddTargets(_window, ScreenBounds(_window, new Rect(0, 0, _window.ActualWidth, _window.ActualHeight)), ref order);
+            _targetIndex.EndUpdate();
+        }
+
+        /// <param name="clip">The part of the screen the parent's clipping leaves visible.</param>
+        void AddTargets(DependencyObject parent, Rect clip, ref int order)
+        {
+            int count = VisualTreeHelper.GetChildrenCount(parent);
+            for (int i = 0; i < count; i++)
+            {
+                var child = VisualTreeHelper.GetChild(parent, i);
+
+                // the hit test does not look inside hidden elements either
+                var element = child as UIElement;
+                if ((element != null) && (!element.IsVisible || !element.IsHitTestVisible))
+                {
+                    continue;
+                }
+
+                // The clip covers ClipToBounds and the viewport of a scroll viewer, so targets scrolled
+                // out of view are left out rather than found under whatever is drawn in their place
+                Rect childClip = clip;
+                var visual = child as Visual;
+                var geometry = (visual != null) ? VisualTreeHelper.GetClip(visual) : null;
+                if (geometry != null)
+                {
+                    childClip.Intersect(ScreenBounds(visual, geometry.Bounds));
+                    if (childClip.IsEmpty)
+                    {
+                        continue;
+                    }
+                }
+
+                var target = child as FrameworkElement;
+                if ((target != null) && IsGazeTarget(target))
+                {
+                    Rect bounds = ScreenBounds(target, new Rect(0, 0, target.ActualWidth, target.ActualHeight));
+                    bounds.Intersect(childClip);
+                    if (!bounds.IsEmpty)
+                    {
+                        _targetIndex.Set(target, bounds.Left, bounds.Top, bounds.Right, bounds.Bottom, order++);
+                    }
+                }
+
+                AddTargets(child, childClip, ref order);
+            }
+        }
+
+        static Rect ScreenBounds(Visual visual, Rect bounds)
+        {
+            return new Rect(visual.PointToScreen(bounds.TopLeft), visual.PointToScreen(bounds.BottomRight));
+        }
+
+        static bool IsDrawnAt(FrameworkElement target, Point screen)
+        {
+            try
+            {
+                Point point = target.PointFromScreen(screen);
+                return (point.X >= 0) && (point.Y >= 0) && (point.X <= target.ActualWidth) && (point.Y <= target.ActualHeight);
+            }
+            catch (System.InvalidOperationException)
+            {
+                // no longer connected to a presentation source
+                return false;
+            }
+        }
+
         FrameworkElement GetHitTarget(GazeEventArgs ev)
         {
+            if ((ev.Scaled.X < 0) || (ev.Scaled.Y < 0) || (ev.Scaled.X > 1) || (ev.Scaled.Y > 1))
+            {
+                return _offScreenElement;
+            }
+
             var pt = new User32.POINT() { X = (int)ev.Screen.X, Y = (int)ev.Screen.Y };
             var hwnd = User32.WindowFromPoint(pt);            
             if ((_hwndMain != hwnd) && (!User32.IsChild(_hwndMain, hwnd)) && _hwndCursor != hwnd && _hwndMouseListner != hwnd)
@@ -738,9 +925,31 @@ namespace Microsoft.HandsFree.GazePointer
                 return _offScreenElement;
             }
 
-            if ((ev.Scaled.X < 0) || (ev.Scaled.Y < 0) || (ev.Scaled.X > 1) || (ev.Scaled.Y > 1))
+            FrameworkElement indexedTarget = null;
+            if (_settings.UseHitTestIndex)
             {
-                return _offScreenElement;
+                UpdateTargetIndex();
+                indexedTarget = _targetIndex.Find(ev.Screen.X, ev.Screen.Y, _hitTarget);
+                if ((indexedTarget != null) && (!indexedTarget.IsVisible || !indexedTarget.IsHitTestVisible))
+                {
+                    _targetIndexDirty = true;
+                    indexedTarget = null;
+                }
+
+                // While the gaze stays on a target the full hit test last agreed on, with no other target
+                // drawn over it, that target is kept. A new target is always confirmed by the full hit
+                // test, which sees overlays and GazeElement redirection that the index does not.
+                if ((indexedTarget != null) && (indexedTarget == _hitTarget) && (indexedTarget == _confirmedTarget))
+                {
+                    if (IsDrawnAt(indexedTarget, ev.Screen))
+                    {
+                        return indexedTarget;
+                    }
+
+                    // moved without being resized, so the index is out of date
+                    _targetIndexDirty = true;
+                    indexedTarget = null;
+                }
             }
 
             FrameworkElement hitTarget;
@@ -762,6 +971,16 @@ namespace Microsoft.HandsFree.GazePointer
                 hitTarget = _offScreenElement;
             }
 
+            if (_settings.UseHitTestIndex)
+            {
+                if ((indexedTarget != null) && (indexedTarget != hitTarget))
+                {
+                    // something the index cannot see covers part of this target
+                    _unconfirmedTargets.Add(indexedTarget);
+                }
+                _confirmedTarget = ((hitTarget == indexedTarget) && !_unconfirmedTargets.Contains(hitTarget)) ? hitTarget : null;
+            }
+
             return hitTarget;
         }
 
@@ -795,61 +1014,27 @@ namespace Microsoft.HandsFree.GazePointer
         void ResetHistory()
         {
             _gazeHistory.Clear();
-            _hitTargetTimes.Clear();
         }
 
         FrameworkElement GetHitTargetWithMaxTime(GazeEventArgs ev, out long elapsedTime)
         {
-            elapsedTime = 0;
             FrameworkElement hitTarget = GetHitTarget(ev);            
             Debug.Assert(hitTarget != null);
 
-            // append this gaze history item and append to the list
-            var historyItem = new GazeHistoryItem { HitTarget = hitTarget, Timestamp = ev.Timestamp };
-
-            if (_gazeHistory.Count == 0)
-            {
-                _gazeHistory.Add(historyItem);
-                _hitTargetTimes[hitTarget] = 0;
-                return hitTarget;
-            }
-
-            // find elapsed time since we got the last hit target
-            int elapsed = 0, elapsedPrev = 0;
-            elapsed = (int)(ev.Timestamp - _gazeHistory[_gazeHistory.Count - 1].Timestamp);
-            historyItem.Duration = elapsed;
-            _gazeHistory.Add(historyItem);
-
-            // update the time this particular hit target has accumulated
-            _hitTargetTimes.TryGetValue(hitTarget, out elapsedPrev);
-            _hitTargetTimes[hitTarget] = elapsedPrev + elapsed;
-
-            // drop the oldest samples from the list until we have samples only 
-            // within the window we are monitoring
-            while (_gazeHistory[_gazeHistory.Count - 1].Timestamp - _gazeHistory[0].Timestamp > _maxHistoryTime)
-            {
-                var evOldest = _gazeHistory[0];
-                _gazeHistory.RemoveAt(0);
-
-                var elapsedOldest = _gazeHistory[0].Timestamp - evOldest.Timestamp;
-
-                _hitTargetTimes[evOldest.HitTarget] -= evOldest.Duration;
-                Debug.Assert(_hitTargetTimes[evOldest.HitTarget] >= 0);
-            }
-
-
             // return the most recent hit target along with the 
             // time it has accumulated within the window of history 
             // we are maintaining
-            elapsedTime = _hitTargetTimes[hitTarget];
+            elapsedTime = _gazeHistory.Add(hitTarget, ev.Timestamp);
             return hitTarget;
         }
 
-        void GazeDataHandler(GazeEventArgs gazeEventArgs)
+        void GazeDataHandler(GazeEventArgs ev)
         {
             FrameworkElement hitTarget = null;
             long elapsedTime;
 
+            ev.Stages.Dispatch = GazeStageTimestamps.Now;
+
             _idleDetector.Tick();
 
             if (!VerifyWindowContext())
@@ -857,17 +1042,14 @@ namespace Microsoft.HandsFree.GazePointer
                 return;
             }
 
-            // if logging is turned on, log the original data, not the filtered data
-            if ((_sensorSettings.Sensor != Sensors.Sensors.LogPlayback) && (_loggingSettings.LogGazeData))
-            {
-                _logFilter.Update(gazeEventArgs);
-            }
-
-            GazeEventArgs ev = _xyFilter.Update(gazeEventArgs);
-
             UpdateCursorPosition(ev.Screen);
+            ev.Stages.CursorUpdate = GazeStageTimestamps.Now;
 
-            if ((hitTarget = GetHitTargetWithMaxTime(ev, out elapsedTime)) == null)
+            hitTarget = GetHitTargetWithMaxTime(ev, out elapsedTime);
+            ev.Stages.HitTestExit = GazeStageTimestamps.Now;
+            Latency.Record(ref ev.Stages);
+
+            if (hitTarget == null)
             {
                 return;
             }
@@ -0,0 +1,301 @@
+using System;
+using System.Collections.Generic;
+
+namespace Microsoft.HandsFree.GazePointer
+{
+    /// <summary>
+    /// Spatial index of the bounds of gaze targets, answering which target is under a point.
+    /// Targets are bucketed into a uniform grid of square cells, so a query only looks at the few
+    /// targets sharing the point's cell. Where targets overlap, the one with the highest order,
+    /// which is the one drawn last, wins.
+    /// The index is kept up to date incrementally: between BeginUpdate() and EndUpdate() every
+    /// current target is Set(), only targets whose bounds have changed are moved in the grid, and
+    /// targets that were not Set() are removed.
+    /// </summary>
+    public class GazeTargetIndex<T> where T : class
+    {
+        class Entry
+        {
+            public T Target;
+            public double Left, Top, Right, Bottom;
+            public int Order;
+            public int Generation;
+
+            // whether a target drawn later overlaps this one, as of CoveredVersion
+            public bool Covered;
+            public int CoveredVersion = -1;
+
+            public bool Contains(double x, double y)
+            {
+                return x >= Left && x < Right && y >= Top && y < Bottom;
+            }
+        }
+
+        private readonly double _cellSize;
+        private readonly Dictionary<T, Entry> _entries = new Dictionary<T, Entry>();
+        private readonly Dictionary<long, List<Entry>> _cells = new Dictionary<long, List<Entry>>();
+        private int _generation;
+        private int _version;
+
+        /// <param name="cellSize">Side of a grid cell, in the units of the bounds. About the size of
+        /// the smaller targets works well.</param>
+        public GazeTargetIndex(double cellSize = 64)
+        {
+            if (!(cellSize > 0))
+            {
+                throw new ArgumentException("Cell size must be positive");
+            }
+            _cellSize = cellSize;
+        }
+
+        public int Count { get { return _entries.Count; } }
+
+        /// <summary>
+        /// Changes whenever a target is added, moved, reordered or removed.
+        /// </summary>
+        public int Version { get { return _version; } }
+
+        /// <summary>
+        /// Start a pass that sets every current target.
+        /// </summary>
+        public void BeginUpdate()
+        {
+            _generation++;
+        }
+
+        /// <summary>
+        /// Remove every target not set since BeginUpdate().
+        /// </summary>
+        public void EndUpdate()
+        {
+            List<T> stale = null;
+            foreach (var entry in _entries.Values)
+            {
+                if (entry.Generation != _generation)
+                {
+                    (stale ?? (stale = new List<T>())).Add(entry.Target);
+                }
+            }
+
+            if (stale != null)
+            {
+                foreach (var target in stale)
+                {
+                    Remove(target);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Add a target or update its bounds and order. Empty bounds remove it.
+        /// </summary>
+        /// <param name="order">Drawing order; the highest wins where targets overlap.</param>
+        public void Set(T target, double left, double top, double right, double bottom, int order)
+        {
+            if (!(right > left && bottom > top))
+            {
+                Remove(target);
+                return;
+            }
+
+            Entry entry;
+            if (_entries.TryGetValue(target, out entry))
+            {
+                entry.Generation = _generation;
+                if (entry.Left == left && entry.Top == top && entry.Right == right && entry.Bottom == bottom)
+                {
+                    if (entry.Order != order)
+                    {
+                        entry.Order = order;
+                        _version++;
+                    }
+                    return;
+                }
+
+                RemoveFromCells(entry);
+            }
+            else
+            {
+                entry = new Entry { Target = target, Generation = _generation };
+                _entries.Add(target, entry);
+            }
+
+            entry.Left = left;
+            entry.Top = top;
+            entry.Right = right;
+            entry.Bottom = bottom;
+            entry.Order = order;
+            AddToCells(entry);
+            _version++;
+        }
+
+        public bool Remove(T target)
+        {
+            Entry entry;
+            if (!_entries.TryGetValue(target, out entry))
+            {
+                return false;
+            }
+
+            RemoveFromCells(entry);
+            _entries.Remove(target);
+            _version++;
+            return true;
+        }
+
+        public void Clear()
+        {
+            _entries.Clear();
+            _cells.Clear();
+            _version++;
+        }
+
+        public bool TryGetBounds(T target, out double left, out double top, out double right, out double bottom)
+        {
+            Entry entry;
+            if (_entries.TryGetValue(target, out entry))
+            {
+                left = entry.Left;
+                top = entry.Top;
+                right = entry.Right;
+                bottom = entry.Bottom;
+                return true;
+            }
+
+            left = top = right = bottom = 0;
+            return false;
+        }
+
+        /// <summary>
+        /// The topmost target containing the point, or null.
+        /// </summary>
+        public T Find(double x, double y)
+        {
+            List<Entry> cell;
+            if (!_cells.TryGetValue(KeyOf(CellOf(x), CellOf(y)), out cell))
+            {
+                return null;
+            }
+
+            Entry found = null;
+            for (int i = 0; i < cell.Count; i++)
+            {
+                Entry entry = cell[i];
+                if (entry.Contains(x, y) && (found == null || entry.Order > found.Order))
+                {
+                    found = entry;
+                }
+            }
+            return found?.Target;
+        }
+
+        /// <summary>
+        /// As Find(), but while the gaze stays on the last target nothing else is looked at: if the
+        /// point is inside it and nothing is drawn over any part of it, it is the answer.
+        /// </summary>
+        public T Find(double x, double y, T last)
+        {
+            Entry entry;
+            if (last != null && _entries.TryGetValue(last, out entry) && entry.Contains(x, y) && !IsCovered(entry))
+            {
+                return last;
+            }
+            return Find(x, y);
+        }
+
+        private bool IsCovered(Entry entry)
+        {
+            if (entry.CoveredVersion != _version)
+            {
+                entry.Covered = false;
+                ForEachCell(entry, cell =>
+                {
+                    foreach (var other in cell)
+                    {
+                        if (other.Order > entry.Order &&
+                            other.Left < entry.Right && other.Right > entry.Left &&
+                            other.Top < entry.Bottom && other.Bottom > entry.Top)
+                        {
+                            entry.Covered = true;
+                        }
+                    }
+                });
+                entry.CoveredVersion = _version;
+            }
+            return entry.Covered;
+        }
+
+        private void AddToCells(Entry entry)
+        {
+            ForEachKey(entry, key =>
+            {
+                List<Entry> cell;
+                if (!_cells.TryGetValue(key, out cell))
+                {
+                    cell = new List<Entry>();
+                    _cells.Add(key, cell);
+                }
+                cell.Add(entry);
+            });
+        }
+
+        private void RemoveFromCells(Entry entry)
+        {
+            ForEachKey(entry, key =>
+            {
+                List<Entry> cell;
+                if (_cells.TryGetValue(key, out cell))
+                {
+                    cell.Remove(entry);
+                    if (cell.Count == 0)
+                    {
+                        _cells.Remove(key);
+                    }
+                }
+            });
+        }
+
+        private void ForEachCell(Entry entry, Action<List<Entry>> action)
+        {
+            ForEachKey(entry, key =>
+            {
+                List<Entry> cell;
+                if (_cells.TryGetValue(key, out cell))
+                {
+                    action(cell);
+                }
+            });
+        }
+
+        private void ForEachKey(Entry entry, Action<long> action)
+        {
+            int firstX = CellOf(entry.Left);
+            int lastX = LastCellOf(entry.Left, entry.Right);
+            int firstY = CellOf(entry.Top);
+            int lastY = LastCellOf(entry.Top, entry.Bottom);
+            for (int y = firstY; y <= lastY; y++)
+            {
+                for (int x = firstX; x <= lastX; x++)
+                {
+                    action(KeyOf(x, y));
+                }
+            }
+        }
+
+        private int CellOf(double value)
+        {
+            return (int)Math.Floor(value / _cellSize);
+        }
+
+        private int LastCellOf(double low, double high)
+        {
+            // high is exclusive, so an edge on a cell boundary does not reach the next cell
+            return Math.Max(CellOf(low), (int)Math.Ceiling(high / _cellSize) - 1);
+        }
+
+        private static long KeyOf(int x, int y)
+        {
+            return ((long)x << 32) | (uint)y;
+        }
+    }
+}
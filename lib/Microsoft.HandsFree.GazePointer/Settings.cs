@@ -47,6 +47,15 @@ namespace Microsoft.HandsFree.GazePointer
         }
         bool _showCursorTracks;
 
+        // Turn off for windows that draw elements over their gaze targets, which the index cannot see
+        [SettingDescription("Use Hit Test Index")]
+        public bool UseHitTestIndex
+        {
+            get { return _useHitTestIndex; }
+            set { SetProperty(ref _useHitTestIndex, value); }
+        }
+        bool _useHitTestIndex = true;
+
         public Settings()
         {
             CreateDefaultSettings();
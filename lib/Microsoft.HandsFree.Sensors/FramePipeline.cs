@@ -0,0 +1,194 @@
+using System;
+using System.Runtime.InteropServices;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// The DATA_CALLBACK values kept with a camera frame. Matches FRAME_SAMPLE in FramePipelineAPI.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct FrameSample
+    {
+        public long Timestamp;
+        public float X;
+        public float Y;
+        public float LeftEyeSize;
+        public float RightEyeSize;
+        public float DistanceFactor;
+        [MarshalAs(UnmanagedType.U1)]
+        public bool LeftEyeDetected;
+        [MarshalAs(UnmanagedType.U1)]
+        public bool RightEyeDetected;
+    }
+
+    /// <summary>
+    /// A camera frame as seen by the analysis callback. Matches FRAME_INFO in FramePipelineAPI.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct FrameInfo
+    {
+        public long Timestamp;
+        public long Sequence;
+        public int Rows;
+        public int Cols;
+        public int Channels;
+        [MarshalAs(UnmanagedType.U1)]
+        public bool Matched;
+        public FrameSample Sample;
+    }
+
+    /// <summary>
+    /// Measurements of a camera frame. Matches FRAME_METRICS in FramePipelineAPI.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct FrameMetrics
+    {
+        public double MeanLevel;
+        public int PupilPixels;
+        public int GlintPixels;
+    }
+
+    /// <summary>
+    /// Counters since the pipeline was created. Matches FRAME_PIPELINE_STATS in FramePipelineAPI.h.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct FramePipelineStats
+    {
+        public ulong Received;
+        public ulong Dropped;
+        public ulong Matched;
+        public ulong Unmatched;
+        public ulong TimedOut;
+        public ulong Analyzed;
+        public ulong WithoutPupil;
+        public ulong WithoutGlint;
+        public ulong Recorded;
+        public ulong RecordErrors;
+        public ulong BytesRecorded;
+    }
+
+    /// <summary>
+    /// Called on the pipeline's worker thread for every frame. The data is only valid during the call.
+    /// </summary>
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate void FrameAnalysisCallback(ref FrameInfo frame, ref FrameMetrics metrics, IntPtr data, IntPtr context);
+
+    /// <summary>
+    /// Camera frames from the IrisBond IMAGE_CALLBACK, taken off the tracker's thread by the native
+    /// frame pipeline (lib/FramePipeline). PushFrame() copies the frame into a preallocated slot and
+    /// returns; the pipeline's own threads tie it to its gaze sample, measure it and record it. When
+    /// the pipeline falls behind, frames are dropped and counted rather than holding up the gaze.
+    /// </summary>
+    public sealed class FramePipeline : IDisposable
+    {
+        private const string DllName = "FramePipeline.dll";
+
+        private IntPtr _pipeline;
+
+        // Kept so the delegate is not collected while the native code can call it
+        private FrameAnalysisCallback _analysisCallback;
+
+        public FramePipeline()
+        {
+            _pipeline = createFramePipeline(IntPtr.Zero);
+            if (_pipeline == IntPtr.Zero)
+            {
+                throw new InvalidOperationException("Cannot create the frame pipeline");
+            }
+        }
+
+        public FramePipelineStats Stats
+        {
+            get
+            {
+                FramePipelineStats stats;
+                getFramePipelineStats(_pipeline, out stats);
+                return stats;
+            }
+        }
+
+        /// <summary>
+        /// Hand a frame to the pipeline. Call from the IMAGE_CALLBACK.
+        /// </summary>
+        /// <returns>false if the frame was dropped.</returns>
+        public bool PushFrame(IntPtr data, int rows, int cols, int channels, long timestamp)
+        {
+            return pushFrame(_pipeline, data, rows, cols, channels, timestamp);
+        }
+
+        /// <summary>
+        /// Hand the pipeline the sample for the frame with the same timestamp. Call from the DATA_CALLBACK.
+        /// </summary>
+        public void PushSample(long timestamp, float x, float y, bool leftEyeDetected, bool rightEyeDetected,
+            float leftEyeSize, float rightEyeSize, float distanceFactor)
+        {
+            pushFrameSample(_pipeline, timestamp, x, y, leftEyeDetected, rightEyeDetected, leftEyeSize, rightEyeSize, distanceFactor);
+        }
+
+        /// <summary>
+        /// Set the function called for every frame, or null for none.
+        /// </summary>
+        public void SetAnalysisCallback(FrameAnalysisCallback callback)
+        {
+            setFrameAnalysisCallback(_pipeline, callback, IntPtr.Zero);
+            _analysisCallback = callback;
+        }
+
+        /// <summary>
+        /// Start writing frames to a new frame log, replacing any existing file.
+        /// </summary>
+        public bool StartRecording(string path)
+        {
+            return startFrameRecording(_pipeline, path);
+        }
+
+        /// <summary>
+        /// Wait for the frames already pushed to be processed, write them out and close the frame log.
+        /// </summary>
+        public void StopRecording()
+        {
+            stopFrameRecording(_pipeline);
+        }
+
+        /// <summary>
+        /// Stop recording and release the pipeline. No frames or samples may be pushed after this.
+        /// </summary>
+        public void Dispose()
+        {
+            if (_pipeline != IntPtr.Zero)
+            {
+                destroyFramePipeline(_pipeline);
+                _pipeline = IntPtr.Zero;
+                _analysisCallback = null;
+            }
+        }
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr createFramePipeline(IntPtr config);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void destroyFramePipeline(IntPtr pipeline);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        private static extern bool pushFrame(IntPtr pipeline, IntPtr data, int rows, int cols, int channels, long timestamp);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void pushFrameSample(IntPtr pipeline, long timestamp, float x, float y,
+            [MarshalAs(UnmanagedType.U1)] bool leftEyeDetected, [MarshalAs(UnmanagedType.U1)] bool rightEyeDetected,
+            float leftEyeSize, float rightEyeSize, float distanceFactor);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void setFrameAnalysisCallback(IntPtr pipeline, FrameAnalysisCallback callback, IntPtr context);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        private static extern bool startFrameRecording(IntPtr pipeline, string path);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void stopFrameRecording(IntPtr pipeline);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void getFramePipelineStats(IntPtr pipeline, out FramePipelineStats stats);
+    }
+}
@@ -5,7 +5,7 @@ namespace Microsoft.HandsFree.Sensors
 {
     public class GazeDataProvider
     {
-        public static IGazeDataProvider InitializeGazeDataProvider(Settings settings = null)
+        public static IGazeDataProvider InitializeGazeDataProvider(Settings settings = null, LoggingSettings loggingSettings = null)
         {
 
             if (settings == null)
@@ -26,7 +26,7 @@ namespace Microsoft.HandsFree.Sensors
                     gazeDataProvider = new MouseSdk();
                     break;
                 case Sensors.LogPlayback:
-                    gazeDataProvider = new LogPlaybackSdk(new LoggingSettings().GazeDataLogFile);
+                    gazeDataProvider = new LogPlaybackSdk(loggingSettings ?? new LoggingSettings());
                     break;
                 case Sensors.None:
                     gazeDataProvider = new NullSdk();
@@ -35,7 +35,7 @@ namespace Microsoft.HandsFree.Sensors
                     gazeDataProvider = new EyeTechDSSensor();
                     break;
                 case Sensors.IrisBond:
-                    gazeDataProvider = new IrisBondSensor();
+                    gazeDataProvider = new IrisBondSensor(loggingSettings ?? new LoggingSettings());
                     break;
                 default:
                     throw new ArgumentException("Unknown sensor type");
@@ -0,0 +1,50 @@
+using System.Windows;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    public struct EyeData
+    {
+        public bool Detected;
+
+        /// <summary>
+        /// Position of the eye in the camera image.
+        /// </summary>
+        public float X;
+        public float Y;
+
+        /// <summary>
+        /// Pupil size reported by the tracker.
+        /// </summary>
+        public float Size;
+    }
+
+    /// <summary>
+    /// Everything a tracker reports with a gaze sample beyond the point itself. Only set by
+    /// sensors that provide it, such as IrisBond; null otherwise.
+    /// </summary>
+    public class GazeDeviceData
+    {
+        /// <summary>
+        /// Timestamp assigned by the tracker, in its own time base.
+        /// </summary>
+        public long DeviceTimestamp;
+
+        /// <summary>
+        /// Gaze point before the tracker's own smoothing, in screen pixels.
+        /// </summary>
+        public Point Raw;
+
+        public int ScreenWidth;
+        public int ScreenHeight;
+        public int ImageWidth;
+        public int ImageHeight;
+
+        public EyeData LeftEye;
+        public EyeData RightEye;
+
+        /// <summary>
+        /// Tracker estimate of the distance of the user relative to the calibrated distance.
+        /// </summary>
+        public float DistanceFactor;
+    }
+}
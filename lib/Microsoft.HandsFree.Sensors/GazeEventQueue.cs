@@ -0,0 +1,143 @@
+using System;
+using System.Collections.Generic;
+using System.Threading;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// Bounded lock-free queue that hands gaze samples from the sensor thread to the UI thread.
+    /// The consumer normally takes only the newest sample and skips the rest, so a UI thread that
+    /// falls behind catches up in one step instead of working through stale samples. When the queue
+    /// is full the oldest sample is discarded, so the newest is never lost.
+    /// </summary>
+    public sealed class GazeEventQueue
+    {
+        // Power of two; 64ms of samples at 1000 Hz
+        public const int DefaultCapacity = 64;
+
+        // Single producer, single consumer: _head is only written by the thread calling Enqueue().
+        // _tail is advanced by the consumer, and by the producer when it discards the oldest sample,
+        // so both advance it with a compare and swap.
+        private readonly GazeEventArgs[] _ring;
+        private readonly long _mask;
+        private long _head;
+        private long _tail;
+        private long _produced;
+        private long _dropped;
+        private long _coalesced;
+
+        public GazeEventQueue(int capacity = DefaultCapacity)
+        {
+            if (capacity <= 0 || (capacity & (capacity - 1)) != 0)
+            {
+                throw new ArgumentException("Capacity must be a power of two");
+            }
+
+            _ring = new GazeEventArgs[capacity];
+            _mask = capacity - 1;
+        }
+
+        public int Capacity { get { return _ring.Length; } }
+
+        /// <summary>
+        /// Samples waiting.
+        /// </summary>
+        public int Count { get { return (int)Math.Max(0, Volatile.Read(ref _head) - Volatile.Read(ref _tail)); } }
+
+        /// <summary>
+        /// Samples queued.
+        /// </summary>
+        public long Produced { get { return Interlocked.Read(ref _produced); } }
+
+        /// <summary>
+        /// Samples discarded because the queue was full.
+        /// </summary>
+        public long Dropped { get { return Interlocked.Read(ref _dropped); } }
+
+        /// <summary>
+        /// Samples skipped because a newer one was taken in their place.
+        /// </summary>
+        public long Coalesced { get { return Interlocked.Read(ref _coalesced); } }
+
+        /// <summary>
+        /// Queue a sample. Only one thread may enqueue.
+        /// </summary>
+        public void Enqueue(GazeEventArgs ea)
+        {
+            long head = _head;
+            long tail = Volatile.Read(ref _tail);
+            if (head - tail >= _ring.Length)
+            {
+                // If this fails the consumer has just emptied the queue, which makes room anyway
+                if (Interlocked.CompareExchange(ref _tail, tail + 1, tail) == tail)
+                {
+                    Interlocked.Increment(ref _dropped);
+                }
+            }
+
+            _ring[head & _mask] = ea;
+            Volatile.Write(ref _head, head + 1);
+            Interlocked.Increment(ref _produced);
+        }
+
+        /// <summary>
+        /// Take the newest sample and discard the rest. Only one thread may dequeue.
+        /// </summary>
+        /// <returns>false if the queue was empty.</returns>
+        public bool TryTakeLatest(out GazeEventArgs latest)
+        {
+            long head = Volatile.Read(ref _head);
+            long tail = Volatile.Read(ref _tail);
+            if (tail >= head)
+            {
+                latest = null;
+                return false;
+            }
+
+            latest = _ring[(head - 1) & _mask];
+
+            while (tail < head)
+            {
+                long previous = Interlocked.CompareExchange(ref _tail, head, tail);
+                if (previous == tail)
+                {
+                    Interlocked.Add(ref _coalesced, head - tail - 1);
+                    break;
+                }
+                tail = previous;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Take every waiting sample, oldest first. Only one thread may dequeue.
+        /// </summary>
+        /// <returns>The number of samples added to the batch.</returns>
+        public int TakeAll(List<GazeEventArgs> batch)
+        {
+            for (;;)
+            {
+                long head = Volatile.Read(ref _head);
+                long tail = Volatile.Read(ref _tail);
+                if (tail >= head)
+                {
+                    return 0;
+                }
+
+                int start = batch.Count;
+                for (long i = tail; i < head; i++)
+                {
+                    batch.Add(_ring[i & _mask]);
+                }
+
+                if (Interlocked.CompareExchange(ref _tail, head, tail) == tail)
+                {
+                    return (int)(head - tail);
+                }
+
+                // the producer discarded the oldest while they were being copied, so start again
+                batch.RemoveRange(start, batch.Count - start);
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+using System;
+using System.IO;
+using System.Text;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// Latency histograms for each stage of the gaze pointer, fed from the stage timestamps
+    /// carried by each sample. Recording is lock-free, so it stays on for every sample.
+    /// </summary>
+    public class GazeLatencyMonitor
+    {
+        private static readonly GazeLatencyStage[] AllStages = (GazeLatencyStage[])Enum.GetValues(typeof(GazeLatencyStage));
+
+        private readonly LatencyHistogram[] _histograms = new LatencyHistogram[AllStages.Length];
+        private DateTime _startTime = DateTime.Now;
+
+        public GazeLatencyMonitor()
+        {
+            for (int i = 0; i < _histograms.Length; i++)
+            {
+                _histograms[i] = new LatencyHistogram();
+            }
+        }
+
+        public LatencyHistogram this[GazeLatencyStage stage]
+        {
+            get { return _histograms[(int)stage]; }
+        }
+
+        /// <summary>
+        /// Add the latency to each stage the sample reached.
+        /// </summary>
+        public void Record(ref GazeStageTimestamps stages)
+        {
+            if (stages.TrackerLatency != 0)
+            {
+                this[GazeLatencyStage.Tracker].RecordTicks(stages.TrackerLatency);
+            }
+
+            long start = stages.CallbackEntry;
+            if (start == 0)
+            {
+                return;
+            }
+
+            RecordStage(GazeLatencyStage.FilterExit, start, stages.FilterExit);
+            RecordStage(GazeLatencyStage.Dispatch, start, stages.Dispatch);
+            RecordStage(GazeLatencyStage.CursorUpdate, start, stages.CursorUpdate);
+            RecordStage(GazeLatencyStage.HitTestExit, start, stages.HitTestExit);
+        }
+
+        public void Reset()
+        {
+            foreach (var histogram in _histograms)
+            {
+                histogram.Reset();
+            }
+            _startTime = DateTime.Now;
+        }
+
+        /// <summary>
+        /// One line per stage with the sample count and the 50th and 99th percentile and maximum
+        /// latencies in milliseconds.
+        /// </summary>
+        public string Report()
+        {
+            var builder = new StringBuilder();
+            builder.AppendLine($"Gaze latency since {_startTime}");
+            builder.AppendLine($"{"Stage",-16}{"Count",10}{"p50 (ms)",12}{"p99 (ms)",12}{"Max (ms)",12}");
+            foreach (var stage in AllStages)
+            {
+                var histogram = this[stage];
+                builder.AppendLine($"{stage,-16}{histogram.Count,10}{histogram.Percentile(0.5) / 1000.0,12:F3}{histogram.Percentile(0.99) / 1000.0,12:F3}{histogram.Max / 1000.0,12:F3}");
+            }
+            return builder.ToString();
+        }
+
+        /// <summary>
+        /// Write the report to a file, replacing it.
+        /// </summary>
+        public void Dump(string path)
+        {
+            File.WriteAllText(path, Report());
+        }
+
+        private void RecordStage(GazeLatencyStage stage, long start, long end)
+        {
+            if (end != 0)
+            {
+                this[stage].RecordTicks(end - start);
+            }
+        }
+    }
+}
@@ -0,0 +1,22 @@
+using System.ComponentModel;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// The latencies measured for each gaze sample. Tracker is the time from the tracker stamping
+    /// the sample to the sensor callback; the others are from the sensor callback to the stage.
+    /// </summary>
+    public enum GazeLatencyStage
+    {
+        [Description("Tracker")]
+        Tracker,
+        [Description("Filter Exit")]
+        FilterExit,
+        [Description("Dispatch")]
+        Dispatch,
+        [Description("Cursor Update")]
+        CursorUpdate,
+        [Description("Hit Test Exit")]
+        HitTestExit
+    }
+}
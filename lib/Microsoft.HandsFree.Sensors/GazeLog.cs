@@ -0,0 +1,164 @@
+using System;
+using System.Runtime.InteropServices;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    //
+    // Binary gaze log. The file is a GazeLogHeader followed by fixed size GazeLogRecords, appended
+    // as the samples arrive, so a log is complete up to the last record written even if the process
+    // ends without closing it; a partly written last record is ignored. The same layout is defined
+    // for native code in lib/GazeLog/GazeLogFormat.h.
+    //
+
+    [StructLayout(LayoutKind.Explicit, Size = Size)]
+    public struct GazeLogHeader
+    {
+        public const int Size = 64;
+
+        /// <summary>
+        /// "GZLG" read as a little endian uint.
+        /// </summary>
+        public const uint GazeLogMagic = 0x474C5A47;
+        public const ushort CurrentVersion = 1;
+
+        [FieldOffset(0)] public uint Magic;
+        [FieldOffset(4)] public ushort Version;
+        [FieldOffset(6)] public ushort HeaderSize;
+        [FieldOffset(8)] public uint RecordSize;
+
+        /// <summary>
+        /// When the log was started, as a UTC file time.
+        /// </summary>
+        [FieldOffset(16)] public long StartTime;
+
+        public static GazeLogHeader Create()
+        {
+            return new GazeLogHeader
+            {
+                Magic = GazeLogMagic,
+                Version = CurrentVersion,
+                HeaderSize = Size,
+                RecordSize = GazeLogRecord.Size,
+                StartTime = DateTime.UtcNow.ToFileTimeUtc()
+            };
+        }
+
+        public bool IsValid
+        {
+            get
+            {
+                return Magic == GazeLogMagic && Version == CurrentVersion &&
+                       HeaderSize == Size && RecordSize == GazeLogRecord.Size;
+            }
+        }
+    }
+
+    [Flags]
+    public enum GazeLogFlags : byte
+    {
+        None = 0,
+        HasDeviceData = 1,
+        LeftEyeDetected = 2,
+        RightEyeDetected = 4
+    }
+
+    /// <summary>
+    /// One logged gaze sample: the point as the gaze pointer received it, and the tracker's
+    /// device data when the sensor provides it.
+    /// </summary>
+    [StructLayout(LayoutKind.Explicit, Size = Size)]
+    public struct GazeLogRecord
+    {
+        public const int Size = 88;
+
+        [FieldOffset(0)] public long Timestamp;
+        [FieldOffset(8)] public long DeviceTimestamp;
+        [FieldOffset(16)] public double X;
+        [FieldOffset(24)] public double Y;
+        [FieldOffset(32)] public float RawX;
+        [FieldOffset(36)] public float RawY;
+        [FieldOffset(40)] public int ScreenWidth;
+        [FieldOffset(44)] public int ScreenHeight;
+        [FieldOffset(48)] public int ImageWidth;
+        [FieldOffset(52)] public int ImageHeight;
+        [FieldOffset(56)] public float LeftEyeX;
+        [FieldOffset(60)] public float LeftEyeY;
+        [FieldOffset(64)] public float LeftEyeSize;
+        [FieldOffset(68)] public float RightEyeX;
+        [FieldOffset(72)] public float RightEyeY;
+        [FieldOffset(76)] public float RightEyeSize;
+        [FieldOffset(80)] public float DistanceFactor;
+        [FieldOffset(84)] public byte Fixation;
+        [FieldOffset(85)] public GazeLogFlags Flags;
+
+        public static GazeLogRecord FromGazeEventArgs(GazeEventArgs ea)
+        {
+            var record = new GazeLogRecord
+            {
+                Timestamp = ea.Timestamp,
+                X = ea.Scaled.X,
+                Y = ea.Scaled.Y,
+                Fixation = (byte)ea.Fixation
+            };
+
+            var data = ea.DeviceData;
+            if (data != null)
+            {
+                record.DeviceTimestamp = data.DeviceTimestamp;
+                record.RawX = (float)data.Raw.X;
+                record.RawY = (float)data.Raw.Y;
+                record.ScreenWidth = data.ScreenWidth;
+                record.ScreenHeight = data.ScreenHeight;
+                record.ImageWidth = data.ImageWidth;
+                record.ImageHeight = data.ImageHeight;
+                record.LeftEyeX = data.LeftEye.X;
+                record.LeftEyeY = data.LeftEye.Y;
+                record.LeftEyeSize = data.LeftEye.Size;
+                record.RightEyeX = data.RightEye.X;
+                record.RightEyeY = data.RightEye.Y;
+                record.RightEyeSize = data.RightEye.Size;
+                record.DistanceFactor = data.DistanceFactor;
+                record.Flags = GazeLogFlags.HasDeviceData |
+                               (data.LeftEye.Detected ? GazeLogFlags.LeftEyeDetected : GazeLogFlags.None) |
+                               (data.RightEye.Detected ? GazeLogFlags.RightEyeDetected : GazeLogFlags.None);
+            }
+
+            return record;
+        }
+
+        public GazeEventArgs ToGazeEventArgs()
+        {
+            var ea = new GazeEventArgs(X, Y, Timestamp, (Microsoft.HandsFree.Sensors.Fixation)Fixation, true);
+
+            if ((Flags & GazeLogFlags.HasDeviceData) != 0)
+            {
+                ea.DeviceData = new GazeDeviceData
+                {
+                    DeviceTimestamp = DeviceTimestamp,
+                    Raw = new System.Windows.Point(RawX, RawY),
+                    ScreenWidth = ScreenWidth,
+                    ScreenHeight = ScreenHeight,
+                    ImageWidth = ImageWidth,
+                    ImageHeight = ImageHeight,
+                    LeftEye = new EyeData
+                    {
+                        Detected = (Flags & GazeLogFlags.LeftEyeDetected) != 0,
+                        X = LeftEyeX,
+                        Y = LeftEyeY,
+                        Size = LeftEyeSize
+                    },
+                    RightEye = new EyeData
+                    {
+                        Detected = (Flags & GazeLogFlags.RightEyeDetected) != 0,
+                        X = RightEyeX,
+                        Y = RightEyeY,
+                        Size = RightEyeSize
+                    },
+                    DistanceFactor = DistanceFactor
+                };
+            }
+
+            return ea;
+        }
+    }
+}
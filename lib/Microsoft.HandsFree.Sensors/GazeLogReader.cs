@@ -0,0 +1,118 @@
+using System;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// Reads a binary gaze log by mapping it into memory. Records are read straight out of the
+    /// mapping, so opening a log costs the same whatever its length and nothing is parsed.
+    /// </summary>
+    public sealed unsafe class GazeLogReader : IDisposable
+    {
+        private readonly MemoryMappedFile _file;
+        private readonly MemoryMappedViewAccessor _view;
+        private readonly GazeLogRecord* _records;
+        private readonly long _count;
+        private readonly GazeLogHeader _header;
+        private bool _disposed;
+
+        /// <summary>
+        /// True if the file starts with a gaze log header; false for anything else, including the
+        /// comma separated text logs written by earlier versions.
+        /// </summary>
+        public static bool IsGazeLog(string path)
+        {
+            try
+            {
+                using (var stream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete))
+                {
+                    GazeLogHeader header;
+                    return ReadHeader(stream, out header);
+                }
+            }
+            catch (IOException)
+            {
+                return false;
+            }
+        }
+
+        public GazeLogReader(string path)
+        {
+            var stream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete);
+            try
+            {
+                if (!ReadHeader(stream, out _header))
+                {
+                    throw new InvalidDataException($"{path} is not a gaze log");
+                }
+
+                // Whole records only: a log that was being written when the process ended may end part way through one
+                _count = (stream.Length - GazeLogHeader.Size) / GazeLogRecord.Size;
+
+                _file = MemoryMappedFile.CreateFromFile(stream, null, 0, MemoryMappedFileAccess.Read, null, HandleInheritability.None, false);
+            }
+            catch
+            {
+                stream.Dispose();
+                throw;
+            }
+
+            _view = _file.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+
+            byte* p = null;
+            _view.SafeMemoryMappedViewHandle.AcquirePointer(ref p);
+            _records = (GazeLogRecord*)(p + GazeLogHeader.Size);
+        }
+
+        public GazeLogHeader Header { get { return _header; } }
+
+        public long Count { get { return _count; } }
+
+        public GazeLogRecord this[long index]
+        {
+            get
+            {
+                if (index < 0 || index >= _count)
+                {
+                    throw new ArgumentOutOfRangeException(nameof(index));
+                }
+                return _records[index];
+            }
+        }
+
+        public void Dispose()
+        {
+            if (!_disposed)
+            {
+                _disposed = true;
+                _view.SafeMemoryMappedViewHandle.ReleasePointer();
+                _view.Dispose();
+                _file.Dispose();
+            }
+        }
+
+        private static bool ReadHeader(FileStream stream, out GazeLogHeader header)
+        {
+            header = new GazeLogHeader();
+
+            var bytes = new byte[GazeLogHeader.Size];
+            int read = 0;
+            int n;
+            while (read < bytes.Length && (n = stream.Read(bytes, read, bytes.Length - read)) > 0)
+            {
+                read += n;
+            }
+            if (read < bytes.Length)
+            {
+                return false;
+            }
+
+            fixed (byte* p = bytes)
+            {
+                header = *(GazeLogHeader*)p;
+            }
+            return header.IsValid;
+        }
+    }
+}
@@ -0,0 +1,236 @@
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Threading;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// Appends records to a binary gaze log. Write() only copies the record into a lock-free ring,
+    /// so it never blocks the caller on the disk; a background thread drains the ring to the file
+    /// several times a second. If the ring fills up because the disk has stalled, records are
+    /// dropped and counted rather than holding up the gaze pipeline.
+    /// </summary>
+    public sealed class GazeLogWriter : IDisposable
+    {
+        // Power of two; eight seconds of samples at 1000 Hz
+        private const int RingCapacity = 8192;
+        private const int RingMask = RingCapacity - 1;
+        private const int FlushIntervalMs = 100;
+        private const int BufferRecords = 1024;
+
+        private readonly string _path;
+        private readonly TimeSpan _rolloverInterval;
+
+        // Single producer, single consumer: _head is only written by the thread calling Write(),
+        // _tail only by the writer thread.
+        private readonly GazeLogRecord[] _ring = new GazeLogRecord[RingCapacity];
+        private long _head;
+        private long _tail;
+        private long _written;
+        private long _dropped;
+
+        private readonly byte[] _buffer = new byte[BufferRecords * GazeLogRecord.Size];
+        private readonly ManualResetEventSlim _stop = new ManualResetEventSlim(false);
+        private readonly Thread _writerThread;
+        private readonly Stopwatch _fileAge = new Stopwatch();
+        private FileStream _file;
+
+        /// <summary>
+        /// Create the log, replacing any existing file.
+        /// </summary>
+        /// <param name="path">The log file.</param>
+        /// <param name="rolloverInterval">How long to write to one file. When it has been open this long
+        /// it is renamed with a .prev extension, replacing the previous one, and a new log is started, so
+        /// at least this much history is always kept. Zero to write a single file.</param>
+        public GazeLogWriter(string path, TimeSpan rolloverInterval)
+        {
+            _path = path;
+            _rolloverInterval = rolloverInterval;
+            _file = CreateLog(path);
+            _fileAge.Start();
+
+            _writerThread = new Thread(WriterProc)
+            {
+                Name = "GazeLogWriter",
+                IsBackground = true,
+                Priority = ThreadPriority.BelowNormal
+            };
+            _writerThread.Start();
+        }
+
+        public string Path { get { return _path; } }
+
+        /// <summary>
+        /// Records handed to the operating system.
+        /// </summary>
+        public long Written { get { return Interlocked.Read(ref _written); } }
+
+        /// <summary>
+        /// Records lost because the ring was full or the file could not be written.
+        /// </summary>
+        public long Dropped { get { return Interlocked.Read(ref _dropped); } }
+
+        /// <summary>
+        /// Queue a record for writing. Only one thread may write to a log.
+        /// </summary>
+        /// <returns>false if the record was dropped.</returns>
+        public bool Write(ref GazeLogRecord record)
+        {
+            long head = _head;
+            if (head - Volatile.Read(ref _tail) >= RingCapacity)
+            {
+                Interlocked.Increment(ref _dropped);
+                return false;
+            }
+
+            _ring[head & RingMask] = record;
+            Volatile.Write(ref _head, head + 1);
+            return true;
+        }
+
+        public bool Write(GazeEventArgs ea)
+        {
+            var record = GazeLogRecord.FromGazeEventArgs(ea);
+            return Write(ref record);
+        }
+
+        /// <summary>
+        /// Write out everything queued and close the log.
+        /// </summary>
+        public void Dispose()
+        {
+            if (!_stop.IsSet)
+            {
+                _stop.Set();
+                _writerThread.Join();
+                _stop.Dispose();
+            }
+        }
+
+        private static unsafe FileStream CreateLog(string path)
+        {
+            var header = GazeLogHeader.Create();
+            var bytes = new byte[GazeLogHeader.Size];
+            fixed (byte* p = bytes)
+            {
+                *(GazeLogHeader*)p = header;
+            }
+
+            var file = new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.Read | FileShare.Delete, 64 * 1024);
+            file.Write(bytes, 0, bytes.Length);
+            file.Flush();
+            return file;
+        }
+
+        private void WriterProc()
+        {
+            bool stopping;
+            do
+            {
+                stopping = _stop.Wait(FlushIntervalMs);
+                Drain();
+
+                if (!stopping && _rolloverInterval > TimeSpan.Zero && _fileAge.Elapsed >= _rolloverInterval)
+                {
+                    Rollover();
+                }
+            }
+            while (!stopping);
+
+            _file?.Dispose();
+            _file = null;
+        }
+
+        private unsafe void Drain()
+        {
+            long head = Volatile.Read(ref _head);
+            long tail = _tail;
+
+            while (tail != head)
+            {
+                int count = (int)Math.Min(head - tail, BufferRecords);
+                fixed (byte* p = _buffer)
+                {
+                    var records = (GazeLogRecord*)p;
+                    for (int i = 0; i < count; i++)
+                    {
+                        records[i] = _ring[(tail + i) & RingMask];
+                    }
+                }
+
+                // The records are copied out, so their slots can be reused
+                tail += count;
+                Volatile.Write(ref _tail, tail);
+
+                if (_file == null)
+                {
+                    Interlocked.Add(ref _dropped, count);
+                    continue;
+                }
+
+                try
+                {
+                    _file.Write(_buffer, 0, count * GazeLogRecord.Size);
+                    Interlocked.Add(ref _written, count);
+                }
+                catch (IOException)
+                {
+                    // Stop logging rather than take the application down; the file stays valid up to here
+                    Interlocked.Add(ref _dropped, count);
+                    CloseAfterError();
+                }
+            }
+
+            try
+            {
+                // Hand the data to the operating system, so that it survives the process
+                _file?.Flush();
+            }
+            catch (IOException)
+            {
+                CloseAfterError();
+            }
+        }
+
+        private void Rollover()
+        {
+            if (_file == null)
+            {
+                return;
+            }
+
+            try
+            {
+                _file.Dispose();
+                _file = null;
+
+                var previous = _path + ".prev";
+                File.Delete(previous);
+                File.Move(_path, previous);
+                _file = CreateLog(_path);
+                _fileAge.Restart();
+            }
+            catch (IOException)
+            {
+                CloseAfterError();
+            }
+            catch (UnauthorizedAccessException)
+            {
+                CloseAfterError();
+            }
+        }
+
+        private void CloseAfterError()
+        {
+            try
+            {
+                _file?.Dispose();
+            }
+            catch (IOException)
+            {
+            }
+            _file = null;
+        }
+    }
+}
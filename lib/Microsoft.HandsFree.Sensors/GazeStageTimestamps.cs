@@ -0,0 +1,47 @@
+using System.Diagnostics;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// When a gaze sample reached each stage between the tracker and the screen, in Stopwatch
+    /// ticks. A stage the sample has not reached, or that was not measured, is zero.
+    /// </summary>
+    public struct GazeStageTimestamps
+    {
+        /// <summary>
+        /// Time from the tracker stamping the sample to the sensor callback, in Stopwatch ticks,
+        /// for sensors that stamp samples against the system clock.
+        /// </summary>
+        public long TrackerLatency;
+
+        /// <summary>
+        /// The sensor callback was entered.
+        /// </summary>
+        public long CallbackEntry;
+
+        /// <summary>
+        /// The smoothing filter returned.
+        /// </summary>
+        public long FilterExit;
+
+        /// <summary>
+        /// The gaze pointer started handling the sample on the UI thread.
+        /// </summary>
+        public long Dispatch;
+
+        /// <summary>
+        /// The cursor was moved to the filtered point.
+        /// </summary>
+        public long CursorUpdate;
+
+        /// <summary>
+        /// The element under the filtered point was found.
+        /// </summary>
+        public long HitTestExit;
+
+        public static long Now
+        {
+            get { return Stopwatch.GetTimestamp(); }
+        }
+    }
+}
@@ -18,6 +18,16 @@ namespace Microsoft.HandsFree.Sensors
         public long Timestamp;
         public Fixation Fixation;
 
+        /// <summary>
+        /// Everything else the tracker reported with the sample, or null.
+        /// </summary>
+        public GazeDeviceData DeviceData;
+
+        /// <summary>
+        /// When the sample reached each stage of the gaze pointer.
+        /// </summary>
+        public GazeStageTimestamps Stages;
+
         public GazeEventArgs(double x, double y, long timestamp, Fixation fixation, bool scaled)
         {
             Timestamp = timestamp;
@@ -39,8 +49,18 @@ namespace Microsoft.HandsFree.Sensors
         }
 
         public GazeEventArgs(double x, double y, GazeEventArgs ea, bool scaled) : 
-            this(x, y, ea.Timestamp, ea.Fixation, scaled)
+            this(x, y, ea, ea.Fixation, scaled)
+        {
+        }
+
+        /// <summary>
+        /// A new point for the same sample, as produced by a filter.
+        /// </summary>
+        public GazeEventArgs(double x, double y, GazeEventArgs ea, Fixation fixation, bool scaled) :
+            this(x, y, ea.Timestamp, fixation, scaled)
         {
+            DeviceData = ea.DeviceData;
+            Stages = ea.Stages;
         }
 
 
@@ -1,5 +1,6 @@
 ﻿using IrisbondAPI;
 using System;
+using System.Diagnostics;
 using System.Runtime.InteropServices;
 using System.Threading.Tasks;
 
@@ -7,6 +8,15 @@ namespace Microsoft.HandsFree.Sensors
 {
     public class IrisBondSensor : IGazeDataProvider
     {
+        readonly TraceSource _trace = new TraceSource("IrisBondSensor", SourceLevels.Information);
+        readonly LoggingSettings _loggingSettings;
+        FramePipeline _framePipeline;
+
+        public IrisBondSensor(LoggingSettings loggingSettings = null)
+        {
+            _loggingSettings = loggingSettings ?? new LoggingSettings();
+        }
+
         event EventHandler<GazeEventArgs> IGazeDataProvider.GazeEvent
         {
             add
@@ -22,6 +32,11 @@ namespace Microsoft.HandsFree.Sensors
 
         public Sensors Sensor { get { return Sensors.IrisBond; } }
 
+        /// <summary>
+        /// The camera frames, while Record Camera Frames is on; otherwise null.
+        /// </summary>
+        public FramePipeline FramePipeline { get { return _framePipeline; } }
+
         public void BeginAddCalibrationPoint(int x, int y)
         {
         }
@@ -50,18 +65,49 @@ namespace Microsoft.HandsFree.Sensors
             float rightEyeSize,
             float distanceFactor)
         {
+            long callbackEntry = GazeStageTimestamps.Now;
+
+            // The tracker stamps samples in milliseconds since the epoch, which is finer than the
+            // tick count and is taken when the camera frame is processed rather than now
             var eventData = new GazeEventArgs(
                 mouseX,
                 mouseY,
-                Environment.TickCount, Fixation.Unknown, false);
+                timestamp, Fixation.Unknown, false);
+
+            long trackerLatency = DateTimeOffset.UtcNow.ToUnixTimeMilliseconds() - timestamp;
+            eventData.Stages.CallbackEntry = callbackEntry;
+            eventData.Stages.TrackerLatency = trackerLatency > 0 ? (trackerLatency * Stopwatch.Frequency) / 1000 : 0;
+
+            eventData.DeviceData = new GazeDeviceData
+            {
+                DeviceTimestamp = timestamp,
+                Raw = new System.Windows.Point(mouseRawX, pogRawY),
+                ScreenWidth = screenWidth,
+                ScreenHeight = screenHeight,
+                ImageWidth = imageWidth,
+                ImageHeight = imageHeight,
+                LeftEye = new EyeData { Detected = leftEyeDetected, X = leftEyeX, Y = leftEyeY, Size = leftEyeSize },
+                RightEye = new EyeData { Detected = rightEyeDetected, X = rightEyeX, Y = rightEyeY, Size = rightEyeSize },
+                DistanceFactor = distanceFactor
+            };
 
             _gazeEvent?.Invoke(this, eventData);
+
+            // The frame with this timestamp waits in the pipeline for its sample
+            _framePipeline?.PushSample(timestamp, mouseX, mouseY, leftEyeDetected, rightEyeDetected, leftEyeSize, rightEyeSize, distanceFactor);
+        }
+
+        public void imageCallback(IntPtr data, int rows, int cols, int channels, long timestamp)
+        {
+            _framePipeline?.PushFrame(data, rows, cols, channels, timestamp);
         }
 
         IrisbondDuo.DATA_CALLBACK fndataCallback;
+        IrisbondDuo.IMAGE_CALLBACK fnimageCallback;
         public bool Initialize()
         {
             fndataCallback = new IrisbondDuo.DATA_CALLBACK(dataCallback);
+            StartFramePipeline();
             var status = IrisbondDuo.start();
             IrisbondDuo.setDataCallback(fndataCallback);
             return status == IrisbondDuo.START_STATUS.START_OK;
@@ -82,6 +128,40 @@ namespace Microsoft.HandsFree.Sensors
         public void Terminate()
         {
             IrisbondDuo.stop();
+
+            if (_framePipeline != null)
+            {
+                IrisbondDuo.setImageCallback(null);
+                _framePipeline.Dispose();
+                _framePipeline = null;
+            }
+        }
+
+        void StartFramePipeline()
+        {
+            if (!_loggingSettings.RecordCameraFrames)
+            {
+                return;
+            }
+
+            try
+            {
+                _framePipeline = new FramePipeline();
+                if (!_framePipeline.StartRecording(_loggingSettings.CameraFrameLogFile))
+                {
+                    _trace.TraceInformation("Cannot record camera frames to {0}", _loggingSettings.CameraFrameLogFile);
+                }
+
+                fnimageCallback = new IrisbondDuo.IMAGE_CALLBACK(imageCallback);
+                IrisbondDuo.setImageCallback(fnimageCallback);
+            }
+            catch (Exception ex) when (ex is DllNotFoundException || ex is InvalidOperationException)
+            {
+                // The gaze works the same without the frames
+                _trace.TraceInformation("EXCEPTION: {0}", ex.Message);
+                _framePipeline?.Dispose();
+                _framePipeline = null;
+            }
         }
 
     }
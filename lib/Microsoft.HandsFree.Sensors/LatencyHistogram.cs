@@ -0,0 +1,140 @@
+using System;
+using System.Diagnostics;
+using System.Threading;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// Histogram of latencies in microseconds that any number of threads can record into without
+    /// locking. Values below 64us have a bucket each; above that every power of two is split into
+    /// 32 buckets, so percentiles are within about 3% while the whole range of a long fits in
+    /// under 2000 buckets. The maximum is kept exactly.
+    /// </summary>
+    public class LatencyHistogram
+    {
+        private const int SubBucketBits = 5;
+        private const int SubBucketCount = 1 << SubBucketBits;
+        private const int BucketCount = (64 - SubBucketBits) * SubBucketCount;
+
+        private static readonly double TicksToMicroseconds = 1000000.0 / Stopwatch.Frequency;
+
+        private readonly long[] _counts = new long[BucketCount];
+        private long _count;
+        private long _max;
+
+        public long Count
+        {
+            get { return Volatile.Read(ref _count); }
+        }
+
+        /// <summary>
+        /// Largest value recorded, in microseconds.
+        /// </summary>
+        public long Max
+        {
+            get { return Volatile.Read(ref _max); }
+        }
+
+        public void Record(long microseconds)
+        {
+            long value = Math.Max(0, microseconds);
+
+            Interlocked.Increment(ref _counts[BucketOf(value)]);
+            Interlocked.Increment(ref _count);
+
+            long max = Volatile.Read(ref _max);
+            while (value > max)
+            {
+                long previous = Interlocked.CompareExchange(ref _max, value, max);
+                if (previous == max)
+                {
+                    break;
+                }
+                max = previous;
+            }
+        }
+
+        /// <summary>
+        /// Record a latency measured in Stopwatch ticks.
+        /// </summary>
+        public void RecordTicks(long ticks)
+        {
+            Record((long)(ticks * TicksToMicroseconds));
+        }
+
+        /// <summary>
+        /// The value below which the given fraction of the samples fall, in microseconds. Samples
+        /// recorded while this runs may or may not be counted.
+        /// </summary>
+        public long Percentile(double fraction)
+        {
+            if (fraction >= 1)
+            {
+                return Max;
+            }
+
+            long total = 0;
+            var counts = new long[BucketCount];
+            for (int i = 0; i < BucketCount; i++)
+            {
+                counts[i] = Volatile.Read(ref _counts[i]);
+                total += counts[i];
+            }
+
+            if (total == 0)
+            {
+                return 0;
+            }
+
+            long rank = Math.Max(1, (long)Math.Ceiling(fraction * total));
+            long seen = 0;
+            for (int i = 0; i < BucketCount; i++)
+            {
+                seen += counts[i];
+                if (seen >= rank)
+                {
+                    // the middle of the bucket, but never beyond what has been seen
+                    return Math.Min(Max, LowestOf(i) + ((WidthOf(i) - 1) / 2));
+                }
+            }
+            return Max;
+        }
+
+        public void Reset()
+        {
+            for (int i = 0; i < BucketCount; i++)
+            {
+                Interlocked.Exchange(ref _counts[i], 0);
+            }
+            Interlocked.Exchange(ref _count, 0);
+            Interlocked.Exchange(ref _max, 0);
+        }
+
+        private static int BucketOf(long value)
+        {
+            // shift the value down until it fits in the top half of a 64 entry range
+            int shift = 0;
+            while ((value >> shift) >= 2 * SubBucketCount)
+            {
+                shift++;
+            }
+            return (shift * SubBucketCount) + (int)(value >> shift);
+        }
+
+        private static long LowestOf(int bucket)
+        {
+            if (bucket < 2 * SubBucketCount)
+            {
+                return bucket;
+            }
+
+            int shift = (bucket / SubBucketCount) - 1;
+            return (long)(bucket - (shift * SubBucketCount)) << shift;
+        }
+
+        private static long WidthOf(int bucket)
+        {
+            return bucket < 2 * SubBucketCount ? 1 : 1L << ((bucket / SubBucketCount) - 1);
+        }
+    }
+}
@@ -1,5 +1,8 @@
 using System;
+using System.Collections.Generic;
+using System.Diagnostics;
 using System.IO;
+using System.Runtime.InteropServices;
 using System.Threading;
 using System.Threading.Tasks;
 
@@ -7,19 +10,87 @@ namespace Microsoft.HandsFree.Sensors
 {
     public class LogPlaybackSdk : IGazeDataProvider
     {
+        // Closer to a sample than this the playback thread spins rather than sleeps,
+        // since a sleep can overrun by up to a timer period
+        private const double SpinThresholdMs = 2.0;
+
+        private const long NoSeek = long.MinValue;
+
         private string _logFile;
-        private bool _terminating = false;
+        private volatile bool _terminating = false;
+        private ManualResetEvent _terminateEvent = null;
         private Thread _gazeDataThread = null;
-        private StreamReader _gazeDataReader = null;
+        private GazeLogReader _gazeLogReader = null;
+        private GazeLogRecord[] _textRecords = null;
+        private long _recordCount = 0;
+        private long _seekTimestamp = NoSeek;
+        private readonly object _timingLock = new object();
+        private PlaybackTiming _timing = new PlaybackTiming();
 
 
         public event EventHandler<GazeEventArgs> GazeEvent;
 
+        /// <summary>
+        /// Raised on the playback thread after the last sample in the log has been delivered.
+        /// </summary>
+        public event EventHandler PlaybackCompleted;
+
         public Sensors Sensor {  get { return Sensors.LogPlayback; } }
 
         public LogPlaybackSdk(string logFile)
         {
             _logFile = logFile;
+            Mode = PlaybackMode.RealTime;
+            Speed = 1;
+            StartDelay = 2000;
+        }
+
+        public LogPlaybackSdk(LoggingSettings settings)
+            : this(settings.GazeDataLogFile)
+        {
+            Mode = settings.PlaybackMode;
+            Speed = settings.PlaybackSpeed;
+            StartDelay = settings.PlaybackStartDelay;
+        }
+
+        /// <summary>
+        /// Takes effect when playback starts.
+        /// </summary>
+        public PlaybackMode Mode { get; set; }
+
+        /// <summary>
+        /// Multiple of the logged rate used in Scaled mode.
+        /// </summary>
+        public double Speed { get; set; }
+
+        /// <summary>
+        /// Milliseconds to wait before the first sample, giving the application time to start up.
+        /// </summary>
+        public int StartDelay { get; set; }
+
+        /// <summary>
+        /// Samples in the log, once initialized.
+        /// </summary>
+        public long Count { get { return _recordCount; } }
+
+        /// <summary>
+        /// Timestamps of the first and last samples, once initialized.
+        /// </summary>
+        public long FirstTimestamp { get { return _recordCount != 0 ? GetRecord(0).Timestamp : 0; } }
+        public long LastTimestamp { get { return _recordCount != 0 ? GetRecord(_recordCount - 1).Timestamp : 0; } }
+
+        /// <summary>
+        /// A snapshot of the playback timing so far.
+        /// </summary>
+        public PlaybackTiming Timing
+        {
+            get
+            {
+                lock (_timingLock)
+                {
+                    return _timing.Clone();
+                }
+            }
         }
 
         public bool Initialize()
@@ -29,18 +100,56 @@ namespace Microsoft.HandsFree.Sensors
                 return false;
             }
 
-            _gazeDataReader = new StreamReader(_logFile);
+            // Binary logs are mapped; anything else is read as a text log from an earlier version
+            if (GazeLogReader.IsGazeLog(_logFile))
+            {
+                _gazeLogReader = new GazeLogReader(_logFile);
+                _recordCount = _gazeLogReader.Count;
+            }
+            else
+            {
+                _textRecords = ReadTextLog(_logFile);
+                _recordCount = _textRecords.Length;
+            }
+
+            _terminating = false;
+            _terminateEvent = new ManualResetEvent(false);
             _gazeDataThread = new Thread(new ThreadStart(GazeDataReaderProc));
+            _gazeDataThread.IsBackground = true;
             _gazeDataThread.Start();
             return true;
         }
 
         public void Terminate()
         {
+            if (_gazeDataThread == null)
+            {
+                return;
+            }
+
             _terminating = true;
+            _terminateEvent.Set();
             _gazeDataThread.Join();
-            _gazeDataReader.Close();
-            _gazeDataReader = null;
+            _gazeDataThread = null;
+
+            // Only the playback thread waits on the event, and it has exited
+            _terminateEvent.Dispose();
+            _terminateEvent = null;
+
+            _gazeLogReader?.Dispose();
+            _gazeLogReader = null;
+            _textRecords = null;
+            _recordCount = 0;
+        }
+
+        /// <summary>
+        /// Continue playback from the first sample logged at or after the timestamp. Timing restarts
+        /// from that sample, so it is delivered straight away. May be called from any thread while
+        /// playback is running.
+        /// </summary>
+        public void Seek(long timestamp)
+        {
+            Interlocked.Exchange(ref _seekTimestamp, timestamp);
         }
 
         public Task<bool> CreateProfileAsync()
@@ -64,52 +173,183 @@ namespace Microsoft.HandsFree.Sensors
 
         }
 
-        private GazeEventArgs ParseGazeEventArgs(string line)
+        private static bool ParseGazeLogRecord(string line, out GazeLogRecord record)
         {
+            record = new GazeLogRecord();
+
             string[] parts = line.Split(',');
             if (parts.Length != 3)
             {
-                return null;
+                return false;
             }
 
-            double x = double.Parse(parts[0]);
-            double y = double.Parse(parts[1]);
-            long t = long.Parse(parts[2]);
+            record.X = double.Parse(parts[0]);
+            record.Y = double.Parse(parts[1]);
+            record.Timestamp = long.Parse(parts[2]);
+            record.Fixation = (byte)Fixation.Unknown;
+            return true;
+        }
 
-            GazeEventArgs ea = new GazeEventArgs(x, y, t, Fixation.Unknown, true);
-            return ea;
+        private static GazeLogRecord[] ReadTextLog(string path)
+        {
+            var records = new List<GazeLogRecord>();
+            using (var reader = new StreamReader(path))
+            {
+                string line;
+                while ((line = reader.ReadLine()) != null)
+                {
+                    GazeLogRecord record;
+                    if (ParseGazeLogRecord(line, out record))
+                    {
+                        records.Add(record);
+                    }
+                }
+            }
+            return records.ToArray();
         }
 
-        private void GazeDataReaderProc()
+        private GazeLogRecord GetRecord(long index)
         {
-            string line = null;
-            GazeEventArgs ea = null;
-            long curTimeStamp = 0;
+            return _gazeLogReader != null ? _gazeLogReader[index] : _textRecords[index];
+        }
+
+        /// <summary>
+        /// Index of the first record at or after the timestamp; logs are written in time order.
+        /// </summary>
+        private long FindRecord(long timestamp)
+        {
+            long low = 0;
+            long high = _recordCount;
+            while (low < high)
+            {
+                long middle = low + ((high - low) / 2);
+                if (GetRecord(middle).Timestamp < timestamp)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            return low;
+        }
 
-            line = _gazeDataReader.ReadLine();
-            if (line != null)
+        /// <summary>
+        /// Wait until the stopwatch reaches the due time: sleep while it is well away, then spin.
+        /// </summary>
+        /// <returns>False if playback was terminated while waiting.</returns>
+        private bool WaitUntil(Stopwatch clock, long dueTicks, double ticksPerMs)
+        {
+            for (;;)
             {
-                ea = ParseGazeEventArgs(line);
-                if (ea != null)
+                double remainingMs = (dueTicks - clock.ElapsedTicks) / ticksPerMs;
+                if (remainingMs <= 0)
+                {
+                    return true;
+                }
+
+                if (remainingMs > SpinThresholdMs)
+                {
+                    if (_terminateEvent.WaitOne(Math.Max(1, (int)(remainingMs - SpinThresholdMs))))
+                    {
+                        return false;
+                    }
+                }
+                else if (_terminating)
+                {
+                    return false;
+                }
+                else
                 {
-                    curTimeStamp = ea.Timestamp;
+                    Thread.SpinWait(20);
                 }
             }
+        }
+
+        private void GazeDataReaderProc()
+        {
+            bool paced = Mode != PlaybackMode.AsFastAsPossible;
+            double speed = Mode == PlaybackMode.Scaled && Speed > 0 ? Speed : 1;
 
-            Thread.Sleep(2000);
-            RaiseGazeEvent(ea);
+            // Sleeps otherwise round up to the default 15.6ms timer period
+            if (paced)
+            {
+                timeBeginPeriod(1);
+            }
 
-            while ((!_terminating) && ((line = _gazeDataReader.ReadLine()) != null))
+            try
             {
-                ea = ParseGazeEventArgs(line);
-                if (ea == null)
+                if (StartDelay > 0 && _terminateEvent.WaitOne(StartDelay))
                 {
-                    continue;
+                    return;
                 }
 
-                Thread.Sleep((int)(ea.Timestamp - curTimeStamp));
-                curTimeStamp = ea.Timestamp;
-                RaiseGazeEvent(ea);
+                var clock = Stopwatch.StartNew();
+                double ticksPerMs = Stopwatch.Frequency / 1000.0;
+                long index = 0;
+                bool anchored = false;
+                long anchorTicks = 0;
+                long anchorTimestamp = 0;
+                long previousTimestamp = 0;
+
+                while (!_terminating)
+                {
+                    long seek = Interlocked.Exchange(ref _seekTimestamp, NoSeek);
+                    if (seek != NoSeek)
+                    {
+                        index = FindRecord(seek);
+                        anchored = false;
+                    }
+
+                    if (index >= _recordCount)
+                    {
+                        PlaybackCompleted?.Invoke(this, EventArgs.Empty);
+                        return;
+                    }
+
+                    GazeLogRecord record = GetRecord(index++);
+
+                    if (paced)
+                    {
+                        // Each sample is due relative to the anchor rather than the sample before it, so a
+                        // late sample does not push back the rest of the log. Timestamps going backwards,
+                        // as where logs have been joined, restart the timing.
+                        if (!anchored || record.Timestamp < previousTimestamp)
+                        {
+                            anchorTicks = clock.ElapsedTicks;
+                            anchorTimestamp = record.Timestamp;
+                            anchored = true;
+                        }
+                        previousTimestamp = record.Timestamp;
+
+                        long dueTicks = anchorTicks + (long)((record.Timestamp - anchorTimestamp) * ticksPerMs / speed);
+                        if (!WaitUntil(clock, dueTicks, ticksPerMs))
+                        {
+                            return;
+                        }
+
+                        double errorMs = (clock.ElapsedTicks - dueTicks) / ticksPerMs;
+                        lock (_timingLock)
+                        {
+                            _timing.AddError(errorMs);
+                        }
+                    }
+
+                    RaiseGazeEvent(record.ToGazeEventArgs());
+
+                    lock (_timingLock)
+                    {
+                        _timing.AddDelivery(clock.Elapsed.TotalSeconds);
+                    }
+                }
+            }
+            finally
+            {
+                if (paced)
+                {
+                    timeEndPeriod(1);
+                }
             }
         }
 
@@ -121,5 +361,11 @@ namespace Microsoft.HandsFree.Sensors
                 handler(this, ea);
             }
         }
+
+        [DllImport("winmm.dll")]
+        private static extern uint timeBeginPeriod(uint period);
+
+        [DllImport("winmm.dll")]
+        private static extern uint timeEndPeriod(uint period);
     }
 }
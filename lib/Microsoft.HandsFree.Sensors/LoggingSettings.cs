@@ -14,7 +14,7 @@ namespace Microsoft.HandsFree.Sensors
             set { SetProperty(ref _logGazeData, value); }
         }
 
-        string _gazeDataLogFile = Path.Combine(SettingsDirectory.DefaultSettingsFolder, "GazeLog.txt");
+        string _gazeDataLogFile = Path.Combine(SettingsDirectory.DefaultSettingsFolder, "GazeLog.bin");
         [SettingDescription]
         public string GazeDataLogFile
         {
@@ -29,6 +29,62 @@ namespace Microsoft.HandsFree.Sensors
             get { return _logDuration; }
             set { SetProperty(ref _logDuration, value); }
         }
+
+        bool _logLatency;
+        [SettingDescription("Log Latency")]
+        public bool LogLatency
+        {
+            get { return _logLatency; }
+            set { SetProperty(ref _logLatency, value); }
+        }
+
+        string _latencyLogFile = Path.Combine(SettingsDirectory.DefaultSettingsFolder, "GazeLatency.txt");
+        [SettingDescription]
+        public string LatencyLogFile
+        {
+            get { return _latencyLogFile; }
+            set { SetProperty(ref _latencyLogFile, value); }
+        }
+
+        bool _recordCameraFrames;
+        [SettingDescription("Record Camera Frames")]
+        public bool RecordCameraFrames
+        {
+            get { return _recordCameraFrames; }
+            set { SetProperty(ref _recordCameraFrames, value); }
+        }
+
+        string _cameraFrameLogFile = Path.Combine(SettingsDirectory.DefaultSettingsFolder, "CameraFrames.bin");
+        [SettingDescription]
+        public string CameraFrameLogFile
+        {
+            get { return _cameraFrameLogFile; }
+            set { SetProperty(ref _cameraFrameLogFile, value); }
+        }
+
+        PlaybackMode _playbackMode = PlaybackMode.RealTime;
+        [SettingDescription("Playback Mode")]
+        public PlaybackMode PlaybackMode
+        {
+            get { return _playbackMode; }
+            set { SetProperty(ref _playbackMode, value); }
+        }
+
+        double _playbackSpeed = 10;
+        [SettingDescription("Playback Speed (times real time)", 1.0, 1000.0, 1.0)]
+        public double PlaybackSpeed
+        {
+            get { return _playbackSpeed; }
+            set { SetProperty(ref _playbackSpeed, value); }
+        }
+
+        int _playbackStartDelay = 2000;
+        [SettingDescription("Playback Start Delay (ms)", 0, 10000, 500)]
+        public int PlaybackStartDelay
+        {
+            get { return _playbackStartDelay; }
+            set { SetProperty(ref _playbackStartDelay, value); }
+        }
     }
 
 }
@@ -0,0 +1,14 @@
+using System.ComponentModel;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    public enum PlaybackMode
+    {
+        [Description("Real Time")]
+        RealTime,
+        [Description("Scaled Speed")]
+        Scaled,
+        [Description("As Fast As Possible")]
+        AsFastAsPossible
+    }
+}
@@ -0,0 +1,71 @@
+using System;
+
+namespace Microsoft.HandsFree.Sensors
+{
+    /// <summary>
+    /// How closely log playback kept to the original timing. The error of a sample is how late it
+    /// was delivered compared with when its logged timestamp fell due at the playback speed; it is
+    /// negative if it was early. Not collected when playing back as fast as possible.
+    /// </summary>
+    public class PlaybackTiming
+    {
+        private long _count;
+        private double _mean;
+        private double _sumOfSquares;
+        private double _maxError;
+        private long _delivered;
+        private double _elapsedSeconds;
+
+        /// <summary>
+        /// Samples delivered, in any mode.
+        /// </summary>
+        public long Delivered { get { return _delivered; } }
+
+        /// <summary>
+        /// Wall clock time spent delivering them.
+        /// </summary>
+        public double ElapsedSeconds { get { return _elapsedSeconds; } }
+
+        public double SamplesPerSecond { get { return _elapsedSeconds > 0 ? _delivered / _elapsedSeconds : 0; } }
+
+        /// <summary>
+        /// Samples whose timing error was measured.
+        /// </summary>
+        public long Count { get { return _count; } }
+
+        public double MeanErrorMs { get { return _mean; } }
+
+        public double StandardDeviationMs { get { return _count > 1 ? Math.Sqrt(_sumOfSquares / (_count - 1)) : 0; } }
+
+        /// <summary>
+        /// Largest error either way.
+        /// </summary>
+        public double MaxErrorMs { get { return _maxError; } }
+
+        internal void AddDelivery(double elapsedSeconds)
+        {
+            _delivered++;
+            _elapsedSeconds = elapsedSeconds;
+        }
+
+        internal void AddError(double errorMs)
+        {
+            // Welford's running mean and variance
+            _count++;
+            double delta = errorMs - _mean;
+            _mean += delta / _count;
+            _sumOfSquares += delta * (errorMs - _mean);
+            _maxError = Math.Max(_maxError, Math.Abs(errorMs));
+        }
+
+        internal PlaybackTiming Clone()
+        {
+            return (PlaybackTiming)MemberwiseClone();
+        }
+
+        public override string ToString()
+        {
+            return $"Delivered={Delivered} in {ElapsedSeconds:F3}s, Error mean={MeanErrorMs:F3}ms sd={StandardDeviationMs:F3}ms max={MaxErrorMs:F3}ms";
+        }
+    }
+}